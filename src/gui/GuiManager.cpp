@@ -2,6 +2,7 @@
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
@@ -10,10 +11,21 @@
 // Buffers
 static char codeBuffer[1024 * 16] = "x = 10 + 20";
 static char regexBuffer[256] = "(a|b)*c";
+static char testBuffer[256] = "abbac";
+static int constructionChoice = 0; // Index into NFAConstruction
+
+// Edge label for one byte; non-printable bytes are shown as hex
+static std::string byteLabel(char c) {
+    unsigned char b = (unsigned char)c;
+    if (b > 32 && b < 127) return std::string(1, c);
+    char hex[8];
+    snprintf(hex, sizeof(hex), "\\x%02X", b);
+    return hex;
+}
 
 namespace GUI {
 
-    GuiManager::GuiManager() : parserStepIndex(-1), hasDebugData(false), draggedNodeId(-1), isDraggingNFA(false) {}
+    GuiManager::GuiManager() : parserStepIndex(-1), debugMethod(Automata::NFAConstruction::Thompson), hasDebugData(false), dfaStatesBeforeMinimize(0), draggedNodeId(-1), isDraggingNFA(false) {}
     GuiManager::~GuiManager() {}
 
     bool GuiManager::init() {
@@ -52,6 +64,7 @@ namespace GUI {
             case Automata::TOKEN_RPAREN: return "R_PAREN";
             case Automata::TOKEN_LBRACE: return "L_BRACE";
             case Automata::TOKEN_RBRACE: return "R_BRACE";
+            case Automata::TOKEN_KEYWORD: return "KEYWORD";
             case Automata::TOKEN_UNKNOWN: return "UNKNOWN";
             case Automata::TOKEN_EOF: return "EOF";
             default: return "???";
@@ -328,7 +341,8 @@ namespace GUI {
              std::map<int, std::set<std::string>> targetLabels;
              for (const auto& t : s.transitions) {
                  if (positions.find(t.targetStateId) == positions.end()) continue;
-                 std::string label = (t.input == '\0') ? "eps" : std::string(1, t.input);
+                 std::string label = (t.input == '\0') ? "eps" : byteLabel(t.input);
+                 if (t.rangeEnd != '\0') label += "-" + byteLabel(t.rangeEnd);
                  targetLabels[t.targetStateId].insert(label);
              }
              
@@ -405,31 +419,110 @@ namespace GUI {
         
         ImGui::InputText("Regex", regexBuffer, 256);
         ImGui::SameLine();
+        ImGui::RadioButton("Thompson", &constructionChoice, 0);
+        ImGui::SameLine();
+        ImGui::RadioButton("Glushkov", &constructionChoice, 1);
+        ImGui::SameLine();
         if (ImGui::Button("Visualize")) {
             std::string r = regexBuffer;
             if (!r.empty()) {
                 try {
-                    debugNFA = Automata::RegexParser::toNFA(Automata::RegexParser::toPostfix(r));
-                    debugNFA.optimize(); // Clean up!
-                    
-                    debugDFA = Automata::RegexParser::toDFA(debugNFA, Automata::TOKEN_UNKNOWN);
-                    debugDFA.optimize(); // Clean up!
+                    debugMethod = (constructionChoice == 1) ? Automata::NFAConstruction::Glushkov : Automata::NFAConstruction::Thompson;
+
+                    // Re-visualizing a regex (or going back to an earlier edit) is a cache hit
+                    uint32_t flags = Automata::RegexCache::PLAYGROUND | (constructionChoice == 1 ? Automata::RegexCache::GLUSHKOV : 0);
+                    Automata::RegexCache::Entry entry = Automata::RegexCache::global().getOrCompile({ r, flags, Automata::TOKEN_UNKNOWN }, [&]() {
+                        Automata::CompiledRegex compiled;
+                        compiled.nfa = Automata::RegexParser::toNFA(Automata::RegexParser::toPostfix(r), debugMethod);
+                        compiled.nfa.optimize(); // Clean up!
+
+                        compiled.dfa = Automata::RegexParser::toDFA(compiled.nfa, Automata::TOKEN_UNKNOWN);
+                        compiled.dfa.optimize(); // Clean up!
+                        compiled.statesBeforeMinimize = compiled.dfa.minimize();
+                        compiled.table = Automata::CompiledDFA::compile(compiled.dfa);
+                        return compiled;
+                    });
+                    debugNFA = entry->nfa;
+                    debugDFA = entry->dfa;
+                    dfaStatesBeforeMinimize = entry->statesBeforeMinimize;
+                    debugCompiled = entry->table;
                     
                     hasDebugData = true;
+                    regexError.clear();
                     nfaPositions.clear();
                     dfaPositions.clear();
+                } catch(const std::exception& e) {
+                    regexError = e.what();
                 } catch(...) {}
             }
         }
+
+        // Quick test: no DFA needed. Small patterns run bit-parallel on their
+        // Glushkov NFA, anything bigger on the Pike VM.
+        ImGui::InputText("Test", testBuffer, 256);
+        ImGui::SameLine();
+        if (ImGui::Button("Match")) {
+            std::string r = regexBuffer;
+            try {
+                std::string postfix = Automata::RegexParser::toPostfix(r);
+                Automata::NFA positions = Automata::RegexParser::toNFA(postfix, Automata::NFAConstruction::Glushkov);
+                std::string input = testBuffer;
+                Automata::TokenType type;
+                size_t matched = Automata::NO_MATCH;
+                if (Automata::BitParallelMatcher::supports(positions)) {
+                    Automata::BitParallelMatcher(positions, Automata::TOKEN_UNKNOWN).simulate(input, type, matched);
+                } else {
+                    Automata::PikeVM vm(Automata::RegexParser::toNFA(postfix), Automata::TOKEN_UNKNOWN);
+                    vm.simulate(input, type, matched);
+                }
+                if (matched == input.length()) matchResult = "Full match";
+                else if (matched != Automata::NO_MATCH) matchResult = "Longest prefix match: \"" + input.substr(0, matched) + "\"";
+                else matchResult = "No match";
+                regexError.clear();
+            } catch(const std::exception& e) {
+                regexError = e.what();
+                matchResult.clear();
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Find All")) {
+            try {
+                std::string input = testBuffer;
+                auto matches = Automata::RegexSearch(regexBuffer).findAll(input);
+                matchResult = std::to_string(matches.size()) + " match(es):";
+                for (const auto& m : matches) matchResult += " \"" + input.substr(m.start, m.length) + "\"";
+                regexError.clear();
+            } catch(const std::exception& e) {
+                regexError = e.what();
+                matchResult.clear();
+            }
+        }
+        if (!matchResult.empty()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s", matchResult.c_str());
+        }
+
+        if (!regexError.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", regexError.c_str());
+        }
         
         if (hasDebugData) {
             if (ImGui::BeginTabBar("Graphs")) {
                 if (ImGui::BeginTabItem("NFA")) {
-                    drawAutomaton(debugNFA.states, debugNFA.startStateId, "Thompson NFA (Optimized)", nfaPositions, true);
+                    const char* nfaLabel = (debugMethod == Automata::NFAConstruction::Glushkov) ? "Glushkov NFA (Optimized)" : "Thompson NFA (Optimized)";
+                    drawAutomaton(debugNFA.states, debugNFA.startStateId, nfaLabel, nfaPositions, true);
                     ImGui::EndTabItem();
                 }
                 if (ImGui::BeginTabItem("DFA")) {
-                    drawAutomaton(debugDFA.states, debugDFA.startStateId, "Deterministic FA (Optimized)", dfaPositions, false);
+                    ImGui::TextDisabled("Table: %d states x %d byte classes (%d bytes, %d with 256 columns)",
+                        debugCompiled.getStateCount(), debugCompiled.getClassCount(),
+                        (int)debugCompiled.getTableBytes(), debugCompiled.getStateCount() * 256 * (int)sizeof(int32_t));
+                    Automata::RegexCache::Stats cache = Automata::RegexCache::global().getStats();
+                    ImGui::TextDisabled("Regex cache: %d hits, %d misses, %d entries (%d KB)",
+                        (int)cache.hits, (int)cache.misses, (int)cache.entries, (int)(cache.bytes / 1024));
+                    char dfaLabel[96];
+                    snprintf(dfaLabel, sizeof(dfaLabel), "Deterministic FA (Minimized from %d states)", dfaStatesBeforeMinimize);
+                    drawAutomaton(debugDFA.states, debugDFA.startStateId, dfaLabel, dfaPositions, false);
                     ImGui::EndTabItem();
                 }
                 ImGui::EndTabBar();
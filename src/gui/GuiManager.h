@@ -4,6 +4,9 @@
 #include <map>
 #include "imgui.h"
 #include "../lexer/Lexer.h"
+#include "../lexer/BitParallelMatcher.h"
+#include "../lexer/RegexSearch.h"
+#include "../lexer/RegexCache.h"
 #include "../parser/PDA.h"
 
 namespace GUI {
@@ -29,8 +32,13 @@ namespace GUI {
         
         // Regex Playground State
         Automata::NFA debugNFA;
+        Automata::NFAConstruction debugMethod; // How debugNFA was built
         Automata::DFA debugDFA;
+        Automata::CompiledDFA debugCompiled;
         bool hasDebugData;
+        int dfaStatesBeforeMinimize;
+        std::string regexError; // Last compile error (e.g. a size guard), shown under the input
+        std::string matchResult; // Outcome of the last "Match" run on the test input
         
         // Visual State
         std::map<int, ImVec2> nfaPositions;
@@ -0,0 +1,129 @@
+#include "BitParallelMatcher.h"
+#include <algorithm>
+#include <bitset>
+#include <stdexcept>
+
+namespace Automata {
+
+    // Bytes labelling the edges into each state, or false if some state is
+    // entered by epsilon or by different byte sets from different sources
+    static bool entryBytes(const NFA& nfa, std::vector<std::bitset<256>>& entry) {
+        const int n = (int)nfa.states.size();
+        entry.assign(n, std::bitset<256>());
+        std::vector<bool> seen(n, false);
+
+        for (const auto& s : nfa.states) {
+            // Union per (source, target) first: one position may need several ranges
+            std::vector<std::pair<int, std::bitset<256>>> perTarget;
+            for (const auto& t : s.transitions) {
+                if (t.isEpsilon()) return false;
+                auto it = std::find_if(perTarget.begin(), perTarget.end(), [&](const auto& p) { return p.first == t.targetStateId; });
+                if (it == perTarget.end()) {
+                    perTarget.push_back({ t.targetStateId, std::bitset<256>() });
+                    it = perTarget.end() - 1;
+                }
+                for (int b = t.firstByte(); b <= t.lastByte(); b++) it->second.set(b);
+            }
+            for (const auto& [target, bytes] : perTarget) {
+                if (seen[target] && entry[target] != bytes) return false;
+                seen[target] = true;
+                entry[target] = bytes;
+            }
+        }
+        return true;
+    }
+
+    bool BitParallelMatcher::supports(const std::vector<NFA>& rules) {
+        size_t total = 0;
+        std::vector<std::bitset<256>> entry;
+        for (const auto& nfa : rules) {
+            total += nfa.states.size();
+            if (total > (size_t)MAX_STATES || !entryBytes(nfa, entry)) return false;
+        }
+        return true;
+    }
+
+    BitParallelMatcher::BitParallelMatcher() : chunkCount(0), initial(0), stateCount(0) {
+        std::fill(byteMask, byteMask + 256, 0);
+        for (auto& chunk : reach) std::fill(chunk, chunk + 256, 0);
+    }
+
+    BitParallelMatcher::BitParallelMatcher(const NFA& nfa, TokenType type)
+        : BitParallelMatcher(std::vector<NFA>{ nfa }, std::vector<TokenType>{ type }) {}
+
+    BitParallelMatcher::BitParallelMatcher(const std::vector<NFA>& rules, const std::vector<TokenType>& types)
+        : BitParallelMatcher() {
+        if (!supports(rules)) {
+            throw std::invalid_argument("BitParallelMatcher needs epsilon-free Glushkov NFAs with at most 64 states");
+        }
+        ruleTypes = types;
+
+        // 1. Rules are laid out one after another in the register
+        std::vector<uint64_t> follow;
+        for (const auto& nfa : rules) {
+            int base = stateCount;
+            std::vector<std::bitset<256>> entry;
+            entryBytes(nfa, entry);
+
+            uint64_t accept = 0;
+            std::vector<int> accepting = nfa.acceptingRules();
+            for (const auto& s : nfa.states) {
+                uint64_t bit = (uint64_t)1 << (base + s.id);
+                uint64_t successors = 0;
+                for (const auto& t : s.transitions) successors |= (uint64_t)1 << (base + t.targetStateId);
+                follow.push_back(successors);
+
+                for (int b = 0; b < 256; b++) {
+                    if (entry[s.id].test(b)) byteMask[b] |= bit;
+                }
+                if (accepting[s.id] != -1) accept |= bit;
+            }
+            if (!nfa.states.empty()) initial |= (uint64_t)1 << (base + nfa.startStateId);
+            acceptMasks.push_back(accept);
+            stateCount += (int)nfa.states.size();
+        }
+
+        // 2. reach[k][v]: union of follow sets of the states whose bits are set
+        // in v, for states 8k .. 8k+7
+        chunkCount = (stateCount + 7) / 8;
+        for (int k = 0; k < chunkCount; k++) {
+            for (int v = 1; v < 256; v++) {
+                int low = 0;
+                while (!(v & (1 << low))) low++;
+                int s = 8 * k + low;
+                uint64_t successors = (s < stateCount) ? follow[s] : 0;
+                reach[k][v] = reach[k][v & (v - 1)] | successors;
+            }
+        }
+    }
+
+    bool BitParallelMatcher::simulate(const char* data, size_t length, TokenType& lastToken, size_t& lastInputIndex) const {
+        lastToken = TOKEN_INVALID;
+        lastInputIndex = NO_MATCH;
+        if (empty()) return false;
+
+        uint64_t active = initial;
+        int token = acceptingToken(active);
+        if (token != -1) {
+            lastToken = (TokenType)token;
+            lastInputIndex = 0;
+        }
+
+        for (size_t i = 0; i < length; i++) {
+            uint64_t successors = 0;
+            for (int k = 0; k < chunkCount; k++) {
+                successors |= reach[k][(active >> (8 * k)) & 0xFF];
+            }
+            active = successors & byteMask[(unsigned char)data[i]];
+            if (!active) return false;
+
+            token = acceptingToken(active);
+            if (token != -1) {
+                lastToken = (TokenType)token;
+                lastInputIndex = i + 1;
+            }
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "FA.h"
+
+namespace Automata {
+
+    // Bit-parallel simulation of small Glushkov NFAs (NFAConstruction::Glushkov).
+    // The set of active states is one uint64_t; each input byte costs
+    //     active = reach(active) & byteMask[byte]
+    // where reach() (every state the active ones lead to, ignoring labels) is
+    // looked up 8 states at a time. This works because in a position
+    // automaton all edges into a state carry the same bytes. Linear time,
+    // no determinization, and the tables are built in one pass over the edges.
+    //
+    // Several rules can share the register: each keeps its own start state and
+    // accept mask, and the earliest rule wins among those accepting.
+    class BitParallelMatcher {
+    public:
+        static constexpr int MAX_STATES = 64;
+
+        BitParallelMatcher();
+        BitParallelMatcher(const NFA& nfa, TokenType type);
+        BitParallelMatcher(const std::vector<NFA>& rules, const std::vector<TokenType>& ruleTypes);
+
+        // True if the NFAs are epsilon-free position automata with at most
+        // MAX_STATES states in total. The constructors throw std::invalid_argument otherwise.
+        static bool supports(const std::vector<NFA>& rules);
+        static bool supports(const NFA& nfa) { return supports(std::vector<NFA>{ nfa }); }
+
+        // Anchored longest match, same contract as PikeVM::simulate
+        bool simulate(const char* data, size_t length, TokenType& lastToken, size_t& lastInputIndex) const;
+        bool simulate(const std::string& input, TokenType& lastToken, size_t& lastInputIndex) const {
+            return simulate(input.data(), input.length(), lastToken, lastInputIndex);
+        }
+
+        bool empty() const { return initial == 0; }
+        int getStateCount() const { return stateCount; }
+
+    private:
+        static constexpr int CHUNKS = MAX_STATES / 8;
+
+        uint64_t byteMask[256];           // States entered on each byte
+        uint64_t reach[CHUNKS][256];      // Successors of each 8-state slice of the active set
+        int chunkCount;                   // Slices actually in use
+        uint64_t initial;                 // Start states of every rule
+        std::vector<uint64_t> acceptMasks; // Per rule, in priority order
+        std::vector<TokenType> ruleTypes;
+        int stateCount;
+
+        // Token of the first rule accepting in active, -1 if none
+        int acceptingToken(uint64_t active) const {
+            for (size_t r = 0; r < acceptMasks.size(); r++) {
+                if (active & acceptMasks[r]) return r < ruleTypes.size() ? ruleTypes[r] : TOKEN_INVALID;
+            }
+            return -1;
+        }
+    };
+
+}
@@ -0,0 +1,213 @@
+#pragma once
+#include <cstdint>
+#include "FA.h"
+
+namespace Automata {
+
+    // Compile-time construction of the default lexer (the rules Lexer::init registers).
+    // Those rules are single-byte operators and "head tail*" runs, which can be written
+    // directly as epsilon-free byte-range NFAs sharing one start state. Subset
+    // construction and byte-class compression then run in constexpr, producing static
+    // tables laid out exactly like CompiledDFA's (row 0 dead, accept = TokenType or -1).
+    //
+    // Keep defaultRules() in sync with the regexes in Lexer::init. ScannerGen
+    // compiles those regexes and fails the build if the two tables differ.
+    namespace Builtin {
+
+        constexpr int MAX_NFA_STATES = 64; // Subsets are uint64_t bitmasks
+        constexpr int MAX_DFA_STATES = 64;
+        constexpr int MAX_EDGES = 128;
+        constexpr int MAX_RULES = 32;
+
+        struct ByteRange {
+            unsigned char lo;
+            unsigned char hi;
+        };
+
+        struct RuleNFA {
+            struct Edge {
+                int from;
+                unsigned char lo;
+                unsigned char hi;
+                int to;
+            };
+
+            int stateCount = 1; // State 0 is the shared start state
+            Edge edges[MAX_EDGES] = {};
+            int edgeCount = 0;
+            int acceptRule[MAX_NFA_STATES] = {};
+            TokenType ruleTypes[MAX_RULES] = {};
+            int ruleCount = 0;
+
+            constexpr RuleNFA() {
+                for (int i = 0; i < MAX_NFA_STATES; i++) acceptRule[i] = -1;
+            }
+
+            constexpr int addState() {
+                if (stateCount >= MAX_NFA_STATES) throw "Builtin lexer: too many NFA states";
+                return stateCount++;
+            }
+
+            constexpr void addEdge(int from, unsigned char lo, unsigned char hi, int to) {
+                if (edgeCount >= MAX_EDGES) throw "Builtin lexer: too many NFA edges";
+                edges[edgeCount++] = { from, lo, hi, to };
+            }
+
+            constexpr int addRuleType(TokenType type) {
+                if (ruleCount >= MAX_RULES) throw "Builtin lexer: too many rules";
+                ruleTypes[ruleCount] = type;
+                return ruleCount++;
+            }
+
+            // Exact byte sequence, e.g. "+"
+            constexpr void literal(const char* text, TokenType type) {
+                int rule = addRuleType(type);
+                int current = 0;
+                for (int i = 0; text[i] != '\0'; i++) {
+                    int next = addState();
+                    addEdge(current, (unsigned char)text[i], (unsigned char)text[i], next);
+                    current = next;
+                }
+                acceptRule[current] = rule;
+            }
+
+            // One byte from head followed by any number of bytes from tail
+            template <int H, int T>
+            constexpr void run(const ByteRange (&head)[H], const ByteRange (&tail)[T], TokenType type) {
+                int rule = addRuleType(type);
+                int body = addState();
+                for (int i = 0; i < H; i++) addEdge(0, head[i].lo, head[i].hi, body);
+                for (int i = 0; i < T; i++) addEdge(body, tail[i].lo, tail[i].hi, body);
+                acceptRule[body] = rule;
+            }
+        };
+
+        struct Tables {
+            int stateCount = 0;
+            int classCount = 0;
+            int32_t startState = 0;
+            unsigned char byteClass[256] = {};
+            int32_t table[MAX_DFA_STATES * 256] = {}; // First stateCount * classCount entries used
+            int32_t acceptTokens[MAX_DFA_STATES] = {};
+        };
+
+        constexpr Tables build(const RuleNFA& nfa) {
+            Tables out;
+
+            // 1. Split the byte range at every edge boundary; bytes within one
+            // interval behave identically in every NFA (hence DFA) state
+            bool cut[257] = {};
+            cut[0] = true;
+            cut[256] = true;
+            for (int e = 0; e < nfa.edgeCount; e++) {
+                cut[nfa.edges[e].lo] = true;
+                cut[nfa.edges[e].hi + 1] = true;
+            }
+            int intervalStart[256] = {};
+            int intervalOf[256] = {};
+            int intervalCount = 0;
+            for (int b = 0; b < 256; b++) {
+                if (cut[b]) intervalStart[intervalCount++] = b;
+                intervalOf[b] = intervalCount - 1;
+            }
+
+            // 2. Subset construction over bitmask subsets. Row 0 = dead, row 1 = start
+            uint64_t subsets[MAX_DFA_STATES] = {};
+            int32_t trans[MAX_DFA_STATES][256] = {};
+            int dfaCount = 2;
+            subsets[1] = 1;
+
+            for (int d = 1; d < dfaCount; d++) {
+                for (int iv = 0; iv < intervalCount; iv++) {
+                    int b = intervalStart[iv];
+                    uint64_t next = 0;
+                    for (int e = 0; e < nfa.edgeCount; e++) {
+                        const RuleNFA::Edge& edge = nfa.edges[e];
+                        if (((subsets[d] >> edge.from) & 1) && b >= edge.lo && b <= edge.hi) {
+                            next |= (uint64_t)1 << edge.to;
+                        }
+                    }
+                    if (next == 0) continue;
+
+                    int target = -1;
+                    for (int j = 1; j < dfaCount; j++) {
+                        if (subsets[j] == next) { target = j; break; }
+                    }
+                    if (target == -1) {
+                        if (dfaCount >= MAX_DFA_STATES) throw "Builtin lexer: too many DFA states";
+                        target = dfaCount++;
+                        subsets[target] = next;
+                    }
+                    trans[d][iv] = target;
+                }
+            }
+
+            // Accepting states take the earliest-declared rule they contain
+            out.acceptTokens[0] = -1;
+            for (int d = 1; d < dfaCount; d++) {
+                int rule = -1;
+                for (int s = 0; s < nfa.stateCount; s++) {
+                    if (((subsets[d] >> s) & 1) && nfa.acceptRule[s] != -1 && (rule == -1 || nfa.acceptRule[s] < rule)) {
+                        rule = nfa.acceptRule[s];
+                    }
+                }
+                out.acceptTokens[d] = (rule == -1) ? -1 : (int32_t)nfa.ruleTypes[rule];
+            }
+
+            // 3. Byte classes: intervals whose columns match in every state merge
+            int classOfInterval[256] = {};
+            int representative[256] = {};
+            int classCount = 0;
+            for (int iv = 0; iv < intervalCount; iv++) {
+                int cls = -1;
+                for (int c = 0; c < classCount && cls == -1; c++) {
+                    bool same = true;
+                    for (int d = 0; d < dfaCount && same; d++) {
+                        same = (trans[d][iv] == trans[d][representative[c]]);
+                    }
+                    if (same) cls = c;
+                }
+                if (cls == -1) {
+                    cls = classCount++;
+                    representative[cls] = iv;
+                }
+                classOfInterval[iv] = cls;
+            }
+
+            out.stateCount = dfaCount;
+            out.classCount = classCount;
+            out.startState = 1;
+            for (int b = 0; b < 256; b++) out.byteClass[b] = (unsigned char)classOfInterval[intervalOf[b]];
+            for (int d = 0; d < dfaCount; d++) {
+                for (int c = 0; c < classCount; c++) {
+                    out.table[d * classCount + c] = trans[d][representative[c]];
+                }
+            }
+            return out;
+        }
+
+        // Mirrors the regex rules in Lexer::init, in the same order
+        constexpr RuleNFA defaultRules() {
+            RuleNFA n;
+            n.literal("+", TOKEN_OPERATOR_PLUS);
+            n.literal("-", TOKEN_OPERATOR_MINUS);
+            n.literal("*", TOKEN_OPERATOR_MULT);
+            n.literal("/", TOKEN_OPERATOR_DIV);
+            n.literal("=", TOKEN_OPERATOR_EQ);
+            n.literal("(", TOKEN_LPAREN);
+            n.literal(")", TOKEN_RPAREN);
+            n.literal("{", TOKEN_LBRACE);
+            n.literal("}", TOKEN_RBRACE);
+
+            const ByteRange digit[] = { { '0', '9' } };
+            const ByteRange idStart[] = { { 'A', 'Z' }, { '_', '_' }, { 'a', 'z' } };
+            const ByteRange idChar[] = { { '0', '9' }, { 'A', 'Z' }, { '_', '_' }, { 'a', 'z' } };
+            n.run(digit, digit, TOKEN_NUMBER);
+            n.run(idStart, idChar, TOKEN_IDENTIFIER);
+            return n;
+        }
+
+        inline constexpr Tables DEFAULT_TABLES = build(defaultRules());
+    }
+
+}
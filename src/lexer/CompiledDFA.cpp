@@ -0,0 +1,186 @@
+#include "CompiledDFA.h"
+#include <map>
+#include <algorithm>
+#include <set>
+#include <utility>
+
+namespace Automata {
+
+    namespace {
+        // The lone dead row of an empty CompiledDFA
+        const int32_t DEAD_ROW[1] = { CompiledDFA::DEAD_STATE };
+        const int32_t NOT_ACCEPTING[1] = { -1 };
+        const ScanKernels::ByteRanges NO_LOOPS[1] = {};
+    }
+
+    CompiledDFA::CompiledDFA() : stateCount(1), classCount(1), startState(DEAD_STATE), table(DEAD_ROW), acceptTokens(NOT_ACCEPTING), selfLoops(NO_LOOPS) {
+        std::fill(byteClass, byteClass + 256, 0);
+    }
+
+    CompiledDFA CompiledDFA::compile(const DFA& dfa) {
+        CompiledDFA c;
+        if (dfa.states.empty()) return c;
+
+        // 1. Full 256-wide table. Graph state i becomes row i + 1; row 0 is the dead state
+        auto owned = std::make_shared<OwnedTables>();
+        c.stateCount = (int)dfa.states.size() + 1;
+        std::vector<int32_t> full((size_t)c.stateCount * 256, DEAD_STATE);
+        owned->acceptTokens.assign(c.stateCount, -1);
+
+        for (const auto& s : dfa.states) {
+            int32_t row = s.id + 1;
+            for (const auto& t : s.transitions) {
+                if (t.isEpsilon()) continue; // No epsilons in a DFA
+                for (int b = t.firstByte(); b <= t.lastByte(); b++) {
+                    full[(size_t)row * 256 + b] = t.targetStateId + 1;
+                }
+            }
+            if (s.isFinal) {
+                auto it = dfa.stateTokenMap.find(s.id);
+                owned->acceptTokens[row] = (it != dfa.stateTokenMap.end()) ? it->second : TOKEN_INVALID;
+            }
+        }
+
+        // 2. Byte equivalence classes: bytes whose columns are identical across
+        // every state are interchangeable. Byte 0 is visited first, so bytes no
+        // rule mentions usually end up sharing class 0 with it.
+        std::map<std::vector<int32_t>, int> columnClass;
+        std::vector<int> representative;
+        for (int b = 0; b < 256; b++) {
+            std::vector<int32_t> column(c.stateCount);
+            for (int row = 0; row < c.stateCount; row++) {
+                column[row] = full[(size_t)row * 256 + b];
+            }
+            auto it = columnClass.find(column);
+            if (it == columnClass.end()) {
+                it = columnClass.emplace(column, (int)representative.size()).first;
+                representative.push_back(b);
+            }
+            c.byteClass[b] = (unsigned char)it->second;
+        }
+        c.classCount = (int)representative.size();
+
+        // 3. Compressed table: one column per class
+        owned->table.assign((size_t)c.stateCount * c.classCount, DEAD_STATE);
+        for (int row = 0; row < c.stateCount; row++) {
+            for (int k = 0; k < c.classCount; k++) {
+                owned->table[(size_t)row * c.classCount + k] = full[(size_t)row * 256 + representative[k]];
+            }
+        }
+
+        c.startState = dfa.startStateId + 1;
+        c.adopt(owned);
+        return c;
+    }
+
+    CompiledDFA CompiledDFA::fromTables(int stateCount, int classCount, int32_t startState,
+                                        const unsigned char* byteClass, const int32_t* table, const int32_t* acceptTokens) {
+        CompiledDFA c;
+        c.stateCount = stateCount;
+        c.classCount = classCount;
+        c.startState = startState;
+        std::copy(byteClass, byteClass + 256, c.byteClass);
+        auto owned = std::make_shared<OwnedTables>();
+        owned->table.assign(table, table + (size_t)stateCount * classCount);
+        owned->acceptTokens.assign(acceptTokens, acceptTokens + stateCount);
+        c.adopt(owned);
+        return c;
+    }
+
+    CompiledDFA CompiledDFA::view(int stateCount, int classCount, int32_t startState, const unsigned char* byteClass,
+                                  const int32_t* table, const int32_t* acceptTokens, const ScanKernels::ByteRanges* selfLoops,
+                                  std::shared_ptr<const void> owner) {
+        CompiledDFA c;
+        c.stateCount = stateCount;
+        c.classCount = classCount;
+        c.startState = startState;
+        std::copy(byteClass, byteClass + 256, c.byteClass);
+        c.table = table;
+        c.acceptTokens = acceptTokens;
+        c.selfLoops = selfLoops;
+        c.storage = std::move(owner);
+        return c;
+    }
+
+    void CompiledDFA::adopt(std::shared_ptr<OwnedTables> owned) {
+        table = owned->table.data();
+        acceptTokens = owned->acceptTokens.data();
+
+        // Self-loops expressible as a few byte ranges, for the run kernel
+        std::vector<ScanKernels::ByteRanges>& loops = owned->selfLoops;
+        loops.assign(stateCount, ScanKernels::ByteRanges());
+        for (int32_t row = 1; row < stateCount; row++) {
+            ScanKernels::ByteRanges ranges;
+            bool usable = true;
+            for (int b = 0; b < 256 && usable; b++) {
+                if (next(row, (unsigned char)b) != row) continue;
+                if (ranges.count > 0 && ranges.hi[ranges.count - 1] == b - 1) {
+                    ranges.hi[ranges.count - 1] = (unsigned char)b;
+                } else if (ranges.count < ScanKernels::MAX_RUN_RANGES) {
+                    ranges.lo[ranges.count] = ranges.hi[ranges.count] = (unsigned char)b;
+                    ranges.count++;
+                } else {
+                    usable = false;
+                }
+            }
+            if (usable) loops[row] = ranges;
+        }
+        selfLoops = loops.data();
+        storage = std::move(owned);
+    }
+
+    bool CompiledDFA::equivalent(const CompiledDFA& a, const CompiledDFA& b) {
+        std::set<std::pair<int32_t, int32_t>> seen;
+        std::vector<std::pair<int32_t, int32_t>> work = { { a.startState, b.startState } };
+        seen.insert(work.back());
+
+        while (!work.empty()) {
+            auto [sa, sb] = work.back();
+            work.pop_back();
+            if (a.acceptTokens[sa] != b.acceptTokens[sb]) return false;
+
+            for (int byte = 0; byte < 256; byte++) {
+                std::pair<int32_t, int32_t> next = { a.next(sa, (unsigned char)byte), b.next(sb, (unsigned char)byte) };
+                if (seen.insert(next).second) work.push_back(next);
+            }
+        }
+        return true;
+    }
+
+    int32_t CompiledDFA::simulate(const char* data, size_t length, int32_t& lastFinalState, size_t& lastLength) const {
+        lastFinalState = -1;
+        lastLength = 0;
+
+        // Check if initial state is final (empty match)
+        if (acceptTokens[startState] >= 0) lastFinalState = startState;
+
+        return resume(startState, 0, data, length, lastFinalState, lastLength);
+    }
+
+    int32_t CompiledDFA::resume(int32_t state, size_t consumed, const char* data, size_t length, int32_t& lastFinalState, size_t& lastLength) const {
+        const int32_t* rows = table;
+        const int32_t* accept = acceptTokens;
+        const ScanKernels::ByteRanges* loops = selfLoops;
+        const size_t width = (size_t)classCount;
+        if (state == DEAD_STATE) return state;
+
+        for (size_t i = 0; i < length; i++) {
+            int32_t previous = state;
+            state = rows[(size_t)state * width + byteClass[(unsigned char)data[i]]];
+            if (state == DEAD_STATE) break;
+
+            // The byte just looped back into the same state: consume the rest of
+            // the run in bulk and land on its last byte
+            if (state == previous && loops[state].count && length - i > RUN_MIN_BYTES) {
+                i += ScanKernels::skipRun(data + i + 1, length - i - 1, loops[state]);
+            }
+
+            if (accept[state] >= 0) {
+                lastFinalState = state;
+                lastLength = consumed + i + 1;
+            }
+        }
+        return state;
+    }
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "FA.h"
+#include "ScanKernels.h"
+
+namespace Automata {
+
+    // Immutable, table-driven form of a DFA used for scanning.
+    // State/Transition stay the editable graph form (GUI, optimize, ...);
+    // this flattens it into one int32 row per state so each input byte costs
+    // a class lookup plus a single indexed load.
+    //
+    // Bytes that lead to the same target from every state are folded into one
+    // equivalence class, so rows are numClasses wide instead of 256.
+    //
+    // States that loop on themselves over a few byte ranges (identifier and
+    // number bodies) consume long runs with the SIMD run kernel instead.
+    class CompiledDFA {
+    public:
+        // Row 0 is an explicit dead state: every byte leads back to it
+        static constexpr int32_t DEAD_STATE = 0;
+
+        CompiledDFA();
+
+        static CompiledDFA compile(const DFA& dfa);
+
+        // Wraps tables that were already built elsewhere (e.g. at compile time,
+        // see BuiltinLexer.h) in the layout compile() produces
+        static CompiledDFA fromTables(int stateCount, int classCount, int32_t startState,
+                                      const unsigned char* byteClass, const int32_t* table, const int32_t* acceptTokens);
+
+        // Uses the arrays in place, without copying them or recomputing the
+        // self-loops; owner must keep them alive (e.g. a mapped LexerImage file)
+        static CompiledDFA view(int stateCount, int classCount, int32_t startState, const unsigned char* byteClass,
+                                const int32_t* table, const int32_t* acceptTokens, const ScanKernels::ByteRanges* selfLoops,
+                                std::shared_ptr<const void> owner);
+
+        // True if a and b give every input the same longest match and token, i.e.
+        // their start states are equivalent. Walks the reachable state pairs, so
+        // numbering and byte classes may differ.
+        static bool equivalent(const CompiledDFA& a, const CompiledDFA& b);
+
+        // Same contract as DFA::simulate, but over raw bytes with no copies.
+        // Returns the state reached (DEAD_STATE if the walk died before the end);
+        // lastFinalState / lastLength describe the longest accepting prefix (-1 / 0 if none).
+        int32_t simulate(const char* data, size_t length, int32_t& lastFinalState, size_t& lastLength) const;
+
+        // Continues a walk that is in state after consumed bytes over the next
+        // length bytes at data. lastFinalState / lastLength are only updated by new
+        // accepting prefixes (lengths count from the start of the walk). Lets a
+        // match run on across separately arriving chunks (StreamLexer).
+        int32_t resume(int32_t state, size_t consumed, const char* data, size_t length, int32_t& lastFinalState, size_t& lastLength) const;
+
+        int32_t next(int32_t state, unsigned char byte) const { return table[(size_t)state * classCount + byteClass[byte]]; }
+        bool isAccepting(int32_t state) const { return acceptTokens[state] >= 0; }
+        TokenType tokenFor(int32_t state) const { return (TokenType)acceptTokens[state]; }
+
+        int32_t getStartState() const { return startState; }
+        int getStateCount() const { return stateCount; }
+        int getClassCount() const { return classCount; }
+        unsigned char getByteClass(unsigned char byte) const { return byteClass[byte]; }
+        size_t getTableBytes() const { return (size_t)stateCount * classCount * sizeof(int32_t); }
+        bool empty() const { return startState == DEAD_STATE; }
+
+        // Raw arrays, in the layout described below (for LexerImage)
+        const unsigned char* getByteClasses() const { return byteClass; }
+        const int32_t* getTable() const { return table; }
+        const int32_t* getAcceptTokens() const { return acceptTokens; }
+        const ScanKernels::ByteRanges* getSelfLoops() const { return selfLoops; }
+
+    private:
+        int stateCount;
+        int classCount;
+        int32_t startState;
+        unsigned char byteClass[256];              // Byte -> equivalence class
+        const int32_t* table;                      // stateCount * classCount, row-major
+        const int32_t* acceptTokens;               // TokenType per state, -1 if not accepting
+        const ScanKernels::ByteRanges* selfLoops;  // Bytes that keep each state where it is (count 0 = none usable)
+
+        // Keeps the three arrays alive: vectors for tables built here, the
+        // mapping for a loaded image. Tables never change once built, so copies share it.
+        std::shared_ptr<const void> storage;
+
+        struct OwnedTables {
+            std::vector<int32_t> table;
+            std::vector<int32_t> acceptTokens;
+            std::vector<ScanKernels::ByteRanges> selfLoops;
+        };
+        void adopt(std::shared_ptr<OwnedTables> owned); // Points at owned and fills its selfLoops
+
+        // Runs shorter than this are cheaper to step through one byte at a time
+        static constexpr size_t RUN_MIN_BYTES = 16;
+    };
+
+}
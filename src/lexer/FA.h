@@ -7,6 +7,7 @@
 #include <iostream>
 #include <algorithm>
 #include <queue>
+#include <deque>
 
 namespace Automata {
 
@@ -24,6 +25,7 @@ namespace Automata {
         TOKEN_RPAREN,
         TOKEN_LBRACE,
         TOKEN_RBRACE,
+        TOKEN_KEYWORD,
         TOKEN_UNKNOWN,
         TOKEN_EOF
     };
@@ -35,16 +37,41 @@ namespace Automata {
         int line;
     };
 
+    // Match length the NFA engines (PikeVM, LazyDFA, BitParallelMatcher) report
+    // when no prefix of the input matched
+    constexpr size_t NO_MATCH = (size_t)-1;
+
+    // Zero-copy token: (offset, length) refer back into the tokenized buffer,
+    // which must outlive the span
+    struct TokenSpan {
+        TokenType type;
+        size_t offset;
+        size_t length;
+        int line;
+    };
+
     struct Transition {
         char input; // '\0' for Epsilon
         int targetStateId;
+        char rangeEnd = '\0'; // Character classes: matches bytes input..rangeEnd (unsigned); '\0' = just input
+
+        bool isEpsilon() const { return input == '\0'; }
+        unsigned char firstByte() const { return (unsigned char)input; }
+        unsigned char lastByte() const { return rangeEnd == '\0' ? (unsigned char)input : (unsigned char)rangeEnd; }
+
+        bool matches(char c) const {
+            if (isEpsilon()) return false;
+            unsigned char b = (unsigned char)c;
+            return b >= firstByte() && b <= lastByte();
+        }
         
         bool operator<(const Transition& other) const {
             if (input != other.input) return input < other.input;
+            if (rangeEnd != other.rangeEnd) return rangeEnd < other.rangeEnd;
             return targetStateId < other.targetStateId;
         }
         bool operator==(const Transition& other) const {
-            return input == other.input && targetStateId == other.targetStateId;
+            return input == other.input && rangeEnd == other.rangeEnd && targetStateId == other.targetStateId;
         }
     };
 
@@ -77,6 +104,13 @@ namespace Automata {
             }
         }
 
+        // Byte range transition [first, last]; a one-byte range is stored as a plain transition
+        void addRangeTransition(int from, int to, unsigned char first, unsigned char last) {
+            if (from < (int)states.size()) {
+                states[from].transitions.push_back({ (char)first, to, first == last ? '\0' : (char)last });
+            }
+        }
+
         void optimize() {
             if (states.empty()) return;
 
@@ -158,7 +192,30 @@ namespace Automata {
         }
     };
 
-    class NFA : public AutomatonBase {};
+    class NFA : public AutomatonBase {
+    public:
+        // Combined (multi-rule) NFAs have several accepting states.
+        // Maps each one to the index of the rule it belongs to; a lower index wins
+        // when a DFA state contains accepting states of more than one rule.
+        // Empty for a plain single-regex NFA: finalStateId is the accept state, or,
+        // when it is -1, every isFinal state is (Glushkov NFAs have several).
+        std::map<int, int> acceptRuleMap;
+
+        // Rule index accepted by each state (-1 if none), whichever encoding is used
+        std::vector<int> acceptingRules() const {
+            std::vector<int> rules(states.size(), -1);
+            if (!acceptRuleMap.empty()) {
+                for (const auto& [state, rule] : acceptRuleMap) rules[state] = rule;
+            } else if (finalStateId >= 0) {
+                if (finalStateId < (int)states.size()) rules[finalStateId] = 0;
+            } else {
+                for (const auto& s : states) {
+                    if (s.isFinal) rules[s.id] = 0;
+                }
+            }
+            return rules;
+        }
+    };
 
     class DFA : public AutomatonBase {
     public:
@@ -184,7 +241,7 @@ namespace Automata {
                 bool found = false;
                 
                 for (const auto& t : states[currentState].transitions) {
-                    if (t.input == c) {
+                    if (t.matches(c)) {
                         currentState = t.targetStateId;
                         found = true;
                         break;
@@ -282,5 +339,189 @@ namespace Automata {
             states = newStates;
             stateTokenMap = newTokenMap;
         }
+
+        // Hopcroft partition refinement. States are only merged when they accept
+        // the same TokenType (the initial partition is split by stateTokenMap), so
+        // a minimized lexer DFA still reports the same token for every match.
+        // Missing transitions go to an implicit dead state; states equivalent to
+        // it are dropped. Returns the state count before minimization.
+        int minimize() {
+            int before = (int)states.size();
+            if (states.empty()) return before;
+
+            const int n = (int)states.size();
+            const int dead = n;
+
+            // Alphabet: the elementary byte intervals cut out by every transition's
+            // range, so each symbol is one interval [symbolFirst[c], symbolFirst[c+1])
+            bool cut[257] = {};
+            for (const auto& s : states) {
+                for (const auto& t : s.transitions) {
+                    if (t.isEpsilon()) continue;
+                    cut[t.firstByte()] = true;
+                    cut[t.lastByte() + 1] = true;
+                }
+            }
+            std::vector<int> symbolFirst;
+            int symbolOf[256];
+            for (int b = 0; b < 256; b++) {
+                if (cut[b]) symbolFirst.push_back(b);
+                symbolOf[b] = (int)symbolFirst.size() - 1;
+            }
+            symbolFirst.push_back(256);
+            const int k = (int)symbolFirst.size() - 1;
+
+            // Inverse transitions per symbol, dead state included (it loops on everything)
+            std::vector<int> delta((size_t)(n + 1) * k, dead);
+            for (const auto& s : states) {
+                for (const auto& t : s.transitions) {
+                    if (t.isEpsilon()) continue;
+                    for (int c = symbolOf[t.firstByte()]; c <= symbolOf[t.lastByte()]; c++) {
+                        delta[(size_t)s.id * k + c] = t.targetStateId;
+                    }
+                }
+            }
+            // In CSR form: the predecessors of target on c are
+            // inverseSources[inverseStart[i] .. inverseStart[i + 1]), i = c * (n + 1) + target
+            const size_t rows = (size_t)k * (n + 1);
+            std::vector<int> inverseStart(rows + 1, 0);
+            for (int q = 0; q <= n; q++) {
+                for (int c = 0; c < k; c++) inverseStart[(size_t)c * (n + 1) + delta[(size_t)q * k + c] + 1]++;
+            }
+            for (size_t i = 0; i < rows; i++) inverseStart[i + 1] += inverseStart[i];
+            std::vector<int> inverseSources(rows);
+            std::vector<int> nextSlot(inverseStart.begin(), inverseStart.end() - 1);
+            for (int q = 0; q <= n; q++) {
+                for (int c = 0; c < k; c++) inverseSources[nextSlot[(size_t)c * (n + 1) + delta[(size_t)q * k + c]]++] = q;
+            }
+            nextSlot = std::vector<int>();
+
+            // Initial partition: non-accepting (with dead), then one block per TokenType
+            std::vector<std::vector<int>> blocks;
+            std::vector<int> blockOf(n + 1);
+            std::map<int, int> blockForToken; // -2 = non-accepting, -1 = final without token
+            for (int q = 0; q <= n; q++) {
+                int key = -2;
+                if (q < n && states[q].isFinal) {
+                    auto it = stateTokenMap.find(q);
+                    key = (it != stateTokenMap.end()) ? (int)it->second : -1;
+                }
+                auto it = blockForToken.find(key);
+                if (it == blockForToken.end()) {
+                    it = blockForToken.emplace(key, (int)blocks.size()).first;
+                    blocks.push_back({});
+                }
+                blocks[it->second].push_back(q);
+                blockOf[q] = it->second;
+            }
+
+            // Refinement
+            std::deque<int> work;
+            std::vector<bool> inWork(blocks.size(), true);
+            for (int b = 0; b < (int)blocks.size(); b++) work.push_back(b);
+
+            std::vector<int> hits(n + 1, 0);          // Size of (Y intersect X) per block Y
+            std::vector<int> marked(n + 1, -1);       // Stamp: state is in X
+            int stamp = 0;
+
+            while (!work.empty()) {
+                int a = work.front(); work.pop_front();
+                inWork[a] = false;
+                std::vector<int> splitter = blocks[a];
+
+                for (int c = 0; c < k; c++) {
+                    // X = states that move into the splitter on c
+                    stamp++;
+                    std::vector<int> touched;
+                    for (int target : splitter) {
+                        size_t row = (size_t)c * (n + 1) + target;
+                        for (int i = inverseStart[row]; i < inverseStart[row + 1]; i++) {
+                            int q = inverseSources[i];
+                            if (marked[q] == stamp) continue;
+                            marked[q] = stamp;
+                            int y = blockOf[q];
+                            if (hits[y]++ == 0) touched.push_back(y);
+                        }
+                    }
+
+                    for (int y : touched) {
+                        if (hits[y] < (int)blocks[y].size()) {
+                            // Split Y into the part inside X (new block) and the rest
+                            std::vector<int> inside, outside;
+                            for (int q : blocks[y]) {
+                                (marked[q] == stamp ? inside : outside).push_back(q);
+                            }
+                            int z = (int)blocks.size();
+                            blocks[y] = outside;
+                            blocks.push_back(inside);
+                            inWork.push_back(false);
+                            hits.push_back(0);
+                            for (int q : inside) blockOf[q] = z;
+
+                            if (inWork[y]) {
+                                work.push_back(z);
+                                inWork[z] = true;
+                            } else {
+                                int smaller = (blocks[z].size() <= blocks[y].size()) ? z : y;
+                                work.push_back(smaller);
+                                inWork[smaller] = true;
+                            }
+                        }
+                        hits[y] = 0;
+                    }
+                }
+            }
+
+            // Rebuild: one state per block, dead block dropped, start block first
+            int deadBlock = blockOf[dead];
+            std::vector<int> newId(blocks.size(), -1);
+            std::vector<int> order;
+            order.push_back(blockOf[startStateId]);
+            for (int b = 0; b < (int)blocks.size(); b++) {
+                if (b != deadBlock && b != order[0]) order.push_back(b);
+            }
+            // (If the start block is the dead block it is still kept, as a lone state)
+            for (int i = 0; i < (int)order.size(); i++) newId[order[i]] = i;
+
+            std::vector<State> newStates(order.size());
+            std::map<int, TokenType> newTokenMap;
+            for (int i = 0; i < (int)order.size(); i++) {
+                const std::vector<int>& members = blocks[order[i]];
+                int rep = dead;
+                for (int q : members) {
+                    if (q < n) { rep = q; break; }
+                }
+                State& ns = newStates[i];
+                ns.id = i;
+                ns.isFinal = (rep < n) && states[rep].isFinal;
+                for (int q : members) {
+                    if (q < n) ns.nfaStateIds.insert(states[q].nfaStateIds.begin(), states[q].nfaStateIds.end());
+                }
+                if (rep < n && stateTokenMap.count(rep)) newTokenMap[i] = stateTokenMap[rep];
+
+                if (rep >= n) continue;
+                // Adjacent symbols with the same target are merged back into one range
+                for (int c = 0; c < k; ) {
+                    int tb = blockOf[delta[(size_t)rep * k + c]];
+                    int end = c + 1;
+                    while (end < k && blockOf[delta[(size_t)rep * k + end]] == tb) end++;
+                    if (tb != deadBlock && newId[tb] != -1) {
+                        Transition t{ (char)symbolFirst[c], newId[tb] };
+                        int last = symbolFirst[end] - 1;
+                        if (last != symbolFirst[c]) t.rangeEnd = (char)last;
+                        ns.transitions.push_back(t);
+                    }
+                    c = end;
+                }
+                std::sort(ns.transitions.begin(), ns.transitions.end());
+            }
+
+            if (finalStateId >= 0 && finalStateId < n && newId[blockOf[finalStateId]] != -1) finalStateId = newId[blockOf[finalStateId]];
+            else finalStateId = -1;
+            startStateId = 0;
+            states = newStates;
+            stateTokenMap = newTokenMap;
+            return before;
+        }
     };
 }
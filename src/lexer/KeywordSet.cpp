@@ -0,0 +1,64 @@
+#include "KeywordSet.h"
+#include <stdexcept>
+
+namespace Automata {
+
+    void KeywordSet::add(const std::string& word, TokenType type) {
+        if (word.empty() || word.find('\0') != std::string::npos) {
+            throw std::invalid_argument("Keyword must be non-empty and must not contain a NUL byte");
+        }
+        words.push_back({ word, type });
+        dirty = true;
+    }
+
+    void KeywordSet::build() {
+        if (!dirty) return;
+
+        // 1. Trie: one state per distinct prefix
+        DFA trie;
+        trie.startStateId = trie.addState(false);
+        for (const auto& w : words) {
+            int state = trie.startStateId;
+            for (char c : w.text) {
+                int next = -1;
+                for (const auto& t : trie.states[state].transitions) {
+                    if (t.input == c) { next = t.targetStateId; break; }
+                }
+                if (next == -1) {
+                    next = trie.addState(false);
+                    trie.addTransition(state, next, c);
+                }
+                state = next;
+            }
+            if (!trie.states[state].isFinal) {
+                trie.states[state].isFinal = true;
+                trie.stateTokenMap[state] = w.type;
+            }
+        }
+
+        // 2. Shared suffixes ("-ing", "-ed", ...) collapse into one path
+        trie.minimize();
+        scanner = CompiledDFA::compile(trie);
+        dirty = false;
+    }
+
+    size_t KeywordSet::longestMatch(const char* data, size_t length, TokenType& type, bool* reachedEnd) const {
+        if (reachedEnd) *reachedEnd = false;
+        if (scanner.empty()) return 0;
+
+        int32_t state = scanner.getStartState();
+        size_t best = 0;
+        size_t i = 0;
+        for (; i < length; i++) {
+            state = scanner.next(state, (unsigned char)data[i]);
+            if (state == CompiledDFA::DEAD_STATE) break;
+            if (scanner.isAccepting(state)) {
+                best = i + 1;
+                type = scanner.tokenFor(state);
+            }
+        }
+        if (reachedEnd) *reachedEnd = (i == length && state != CompiledDFA::DEAD_STATE);
+        return best;
+    }
+
+}
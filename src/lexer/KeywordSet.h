@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "FA.h"
+#include "CompiledDFA.h"
+
+namespace Automata {
+
+    // Reserved words and multi-character operators, matched as literals next to
+    // the Lexer's regex rules instead of as one regex rule each.
+    //
+    // The words are put into a trie, which is a DFA already. Minimizing it with
+    // DFA::minimize merges the common suffixes, and the result is compiled into
+    // the same byte-class table form the lexer uses. A lookup is one table walk
+    // that stops at the first byte no keyword continues with, so the cost
+    // depends on the token length and not on the number of keywords.
+    class KeywordSet {
+    public:
+        // Adds word with its token type. The first type given for a word wins.
+        // Throws std::invalid_argument for an empty word or one containing '\0'.
+        void add(const std::string& word, TokenType type);
+
+        struct Word {
+            std::string text;
+            TokenType type;
+        };
+        const std::vector<Word>& getWords() const { return words; } // In the order added
+
+        // Longest keyword at data, 0 if none. reachedEnd is set when more input
+        // could still extend it (a walk still alive at data + length).
+        size_t longestMatch(const char* data, size_t length, TokenType& type, bool* reachedEnd = nullptr) const;
+
+        // Builds the table after add(); longestMatch needs it to be current
+        void build();
+        bool isBuilt() const { return !dirty; }
+
+        bool empty() const { return words.empty(); }
+        size_t size() const { return words.size(); }
+        const CompiledDFA& getScanner() const { return scanner; }
+
+    private:
+        std::vector<Word> words;
+        CompiledDFA scanner;
+        bool dirty = false;
+    };
+
+}
@@ -0,0 +1,168 @@
+#include "LazyDFA.h"
+#include <algorithm>
+
+namespace Automata {
+
+    LazyDFA::LazyDFA() : classCount(1), startState(DEAD), cacheLimit(DEFAULT_CACHE_BYTES), memoryUsed(0), flushes(0), stamp(0) {
+        std::fill(byteClass, byteClass + 256, 0);
+        classByte.assign(1, 0);
+    }
+
+    LazyDFA::LazyDFA(const NFA& nfa, TokenType type, size_t cacheBytes)
+        : LazyDFA(nfa, std::vector<TokenType>{ type }, cacheBytes) {}
+
+    LazyDFA::LazyDFA(const NFA& source, const std::vector<TokenType>& types, size_t cacheBytes)
+        : nfa(source), ruleTypes(types), classCount(1), startState(DEAD), cacheLimit(0), memoryUsed(0), flushes(0), stamp(0) {
+        init(cacheBytes);
+    }
+
+    void LazyDFA::init(size_t cacheBytes) {
+        const int n = (int)nfa.states.size();
+        cacheLimit = std::max(cacheBytes, MIN_CACHE_BYTES);
+
+        // 1. Accepting states and the states worth keeping in a subset
+        ruleOfState = nfa.acceptingRules();
+        important.assign(n, 0);
+        for (int s = 0; s < n; s++) {
+            important[s] = (ruleOfState[s] != -1);
+            for (const auto& t : nfa.states[s].transitions) {
+                if (!t.isEpsilon()) important[s] = 1;
+            }
+        }
+
+        // 2. Byte classes
+        bool cut[257] = {};
+        for (const auto& st : nfa.states) {
+            for (const auto& t : st.transitions) {
+                if (t.isEpsilon()) continue;
+                cut[t.firstByte()] = true;
+                cut[t.lastByte() + 1] = true;
+            }
+        }
+        classByte.clear();
+        cut[0] = true;
+        for (int b = 0; b < 256; b++) {
+            if (cut[b]) classByte.push_back((unsigned char)b);
+            byteClass[b] = (unsigned char)(classByte.size() - 1);
+        }
+        classCount = (int)classByte.size();
+
+        mark.assign(n, 0);
+        stamp = 0;
+        startSubset = n ? closure({ nfa.startStateId }) : std::vector<int>();
+        clearCache();
+    }
+
+    void LazyDFA::clearCache() {
+        cache.clear();
+        next.clear();
+        index.clear();
+        memoryUsed = 0;
+        startState = startSubset.empty() ? DEAD : intern(startSubset);
+    }
+
+    std::vector<int> LazyDFA::closure(const std::vector<int>& seeds) {
+        stamp++;
+        std::vector<int> result;
+        stack.clear();
+        auto visit = [&](int s) {
+            if (mark[s] == stamp) return;
+            mark[s] = stamp;
+            stack.push_back(s);
+            if (important[s]) result.push_back(s);
+        };
+
+        for (int s : seeds) visit(s);
+        while (!stack.empty()) {
+            int u = stack.back(); stack.pop_back();
+            for (const auto& t : nfa.states[u].transitions) {
+                if (t.isEpsilon()) visit(t.targetStateId);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    size_t LazyDFA::stateCost(const std::vector<int>& subset) const {
+        // State record + transition row + hash entry (key copy and node overhead)
+        return sizeof(CachedState) + (size_t)classCount * sizeof(int32_t)
+             + 2 * subset.size() * sizeof(int) + sizeof(std::vector<int>) + 4 * sizeof(void*);
+    }
+
+    int32_t LazyDFA::intern(const std::vector<int>& subset) {
+        auto it = index.find(subset);
+        if (it != index.end()) return it->second;
+
+        int32_t id = (int32_t)cache.size();
+        int best = -1;
+        for (int s : subset) {
+            int rule = ruleOfState[s];
+            if (rule != -1 && (best == -1 || rule < best)) best = rule;
+        }
+
+        CachedState state;
+        state.nfaStates = subset;
+        state.token = (best == -1) ? -1 : (best < (int)ruleTypes.size() ? ruleTypes[best] : TOKEN_INVALID);
+        cache.push_back(std::move(state));
+        next.resize(next.size() + classCount, UNKNOWN);
+        index.emplace(subset, id);
+        memoryUsed += stateCost(subset);
+        return id;
+    }
+
+    int32_t LazyDFA::computeNext(int32_t state, int cls) {
+        // 1. Move on the class's representative byte, then close
+        unsigned char b = classByte[cls];
+        std::vector<int> targets;
+        for (int s : cache[state].nfaStates) {
+            for (const auto& t : nfa.states[s].transitions) {
+                if (!t.isEpsilon() && b >= t.firstByte() && b <= t.lastByte()) targets.push_back(t.targetStateId);
+            }
+        }
+        std::vector<int> subset = closure(targets);
+        if (subset.empty()) {
+            next[(size_t)state * classCount + cls] = DEAD;
+            return DEAD;
+        }
+
+        // 2. Flush if the new state would not fit. The source state is re-added
+        // so its row can still record the transition.
+        if (index.find(subset) == index.end() && memoryUsed + stateCost(subset) > cacheLimit) {
+            std::vector<int> source = cache[state].nfaStates;
+            flushes++;
+            clearCache();
+            state = intern(source);
+        }
+
+        int32_t target = intern(subset);
+        next[(size_t)state * classCount + cls] = target;
+        return target;
+    }
+
+    bool LazyDFA::simulate(const char* data, size_t length, TokenType& lastToken, size_t& lastInputIndex) {
+        lastToken = TOKEN_INVALID;
+        lastInputIndex = NO_MATCH;
+        int32_t state = startState;
+        if (state == DEAD) return false;
+
+        if (cache[state].token != -1) {
+            lastToken = (TokenType)cache[state].token;
+            lastInputIndex = 0;
+        }
+
+        for (size_t i = 0; i < length; i++) {
+            int cls = byteClass[(unsigned char)data[i]];
+            int32_t target = next[(size_t)state * classCount + cls];
+            if (target == UNKNOWN) target = computeNext(state, cls);
+            if (target == DEAD) return false;
+            state = target;
+
+            if (cache[state].token != -1) {
+                lastToken = (TokenType)cache[state].token;
+                lastInputIndex = i + 1;
+            }
+        }
+        return true;
+    }
+
+}
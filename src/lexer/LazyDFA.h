@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "FA.h"
+
+namespace Automata {
+
+    // On-demand DFA over any epsilon-NFA: Thompson, Glushkov, or a combined
+    // rule set such as the Lexer's. Instead of running subset construction up
+    // front (RegexParser::toDFA), DFA states are built the first time the
+    // input reaches them and kept in a cache of at most cacheBytes. When the
+    // cache is full it is flushed and refilled from the current state, so memory
+    // stays bounded even for patterns whose full DFA is exponential, such as
+    // (a|b)*a(a|b){20}.
+    //
+    // Subsets only keep the NFA states that matter for the future: states with
+    // a byte transition and accepting states.
+    class LazyDFA {
+    public:
+        static constexpr size_t DEFAULT_CACHE_BYTES = 1 << 20;
+        static constexpr size_t MIN_CACHE_BYTES = 16 * 1024;
+
+        LazyDFA();
+        LazyDFA(const NFA& nfa, TokenType type, size_t cacheBytes = DEFAULT_CACHE_BYTES);
+        // Combined multi-rule NFA (RegexParser::combineNFAs); the earliest rule wins
+        LazyDFA(const NFA& nfa, const std::vector<TokenType>& ruleTypes, size_t cacheBytes = DEFAULT_CACHE_BYTES);
+
+        // Anchored longest match with the same results as DFA::simulate on the
+        // determinized NFA. The accepting state is reported by its token, as
+        // cached state ids do not survive a flush. lastInputIndex is the match
+        // length, NO_MATCH if no prefix matched. Returns false if the walk died
+        // before the end of input.
+        bool simulate(const char* data, size_t length, TokenType& lastToken, size_t& lastInputIndex);
+        bool simulate(const std::string& input, TokenType& lastToken, size_t& lastInputIndex) {
+            return simulate(input.data(), input.length(), lastToken, lastInputIndex);
+        }
+
+        void clearCache();
+
+        size_t getCachedStates() const { return cache.size(); }
+        size_t getCacheBytes() const { return memoryUsed; }
+        size_t getCacheLimit() const { return cacheLimit; }
+        size_t getFlushCount() const { return flushes; }
+        int getClassCount() const { return classCount; }
+
+    private:
+        static constexpr int32_t DEAD = -1;    // Empty subset
+        static constexpr int32_t UNKNOWN = -2; // Transition not computed yet
+
+        struct SubsetHash {
+            size_t operator()(const std::vector<int>& subset) const {
+                uint64_t h = 1469598103934665603ull; // FNV-1a
+                for (int s : subset) {
+                    h ^= (uint32_t)s;
+                    h *= 1099511628211ull;
+                }
+                return (size_t)h;
+            }
+        };
+
+        struct CachedState {
+            std::vector<int> nfaStates; // Sorted
+            int32_t token;              // TokenType, -1 if not accepting
+        };
+
+        NFA nfa;
+        std::vector<TokenType> ruleTypes;
+        std::vector<int> ruleOfState;   // Accepting rule per NFA state, -1 if none
+        std::vector<char> important;    // Kept in subsets (byte transition or accepting)
+
+        // Byte classes: elementary intervals cut out by the NFA's transitions
+        unsigned char byteClass[256];
+        std::vector<unsigned char> classByte; // One representative byte per class
+        int classCount;
+
+        // Cache
+        std::vector<CachedState> cache;
+        std::vector<int32_t> next; // cache.size() * classCount, UNKNOWN until computed
+        std::unordered_map<std::vector<int>, int32_t, SubsetHash> index;
+        std::vector<int> startSubset;
+        int32_t startState;
+        size_t cacheLimit;
+        size_t memoryUsed;
+        size_t flushes;
+
+        // Closure scratch space
+        std::vector<unsigned> mark;
+        unsigned stamp;
+        std::vector<int> stack;
+
+        void init(size_t cacheBytes);
+        std::vector<int> closure(const std::vector<int>& seeds);
+        int32_t intern(const std::vector<int>& subset);
+        int32_t computeNext(int32_t state, int cls);
+        size_t stateCost(const std::vector<int>& subset) const;
+    };
+
+}
@@ -1,10 +1,20 @@
 #include "Lexer.h"
+#include "ScanKernels.h"
+#include "BuiltinLexer.h"
+#include "Utf8.h"
+#include "RegexCache.h"
+#include "LexerImage.h"
 #include <iostream>
+#include <algorithm>
+#include <thread>
+#include <stdexcept>
 
 namespace Automata {
 
     void Lexer::init() {
-        // Simple manual definitions to avoid complex regex logic issues
+        // Default rules. Keep them in sync with Builtin::defaultRules()
+        // (BuiltinLexer.h); ScannerGen fails the build if the two disagree.
+        bool defaultsOnly = rules.empty();
         
         addRule("\\+", TOKEN_OPERATOR_PLUS);
         addRule("-", TOKEN_OPERATOR_MINUS);
@@ -17,70 +27,379 @@ namespace Automata {
         addRule("\\}", TOKEN_RBRACE);
         
         // Numbers: 0-9 sequence
-        // Explicitly simple: (0|1|2|3|4|5|6|7|8|9)(0|1|2|3|4|5|6|7|8|9)* 
-        // We use a helper string
-        std::string d = "(0|1|2|3|4|5|6|7|8|9)";
-        addRule(d + d + "*", TOKEN_NUMBER);
+        addRule("[0-9][0-9]*", TOKEN_NUMBER);
         
-        // ID: a-z sequence
-        // We limit to a small set for safety if needed, but let's try full
-        std::string a = "(a|b|c|d|e|f|g|h|i|j|k|l|m|n|o|p|q|r|s|t|u|v|w|x|y|z)";
-        addRule(a + "(" + a + "|" + d + ")*", TOKEN_IDENTIFIER);
+        // ID: letter or underscore, then letters, digits and underscores
+        addRule("[a-zA-Z_][a-zA-Z0-9_]*", TOKEN_IDENTIFIER);
+
+        // The same rule set is built at compile time (BuiltinLexer.h), so there is
+        // no regex -> NFA -> DFA work at startup. Rules added later trigger a
+        // normal rebuild of everything.
+        if (defaultsOnly) {
+            const Builtin::Tables& t = Builtin::DEFAULT_TABLES;
+            scanner = CompiledDFA::fromTables(t.stateCount, t.classCount, t.startState, t.byteClass, t.table, t.acceptTokens);
+            combinedDirty = false;
+            combinedGraphBuilt = false;
+        }
     }
 
     void Lexer::addRule(std::string regex, TokenType type) {
-        tokenDFAs.push_back(RegexParser::createDFA(regex, type));
+        rules.push_back({ regex, type });
+        combinedDirty = true;
     }
 
-    std::vector<Token> Lexer::tokenize(std::string input) {
-        std::vector<Token> output;
-        int cursor = 0;
-        int line = 1;
-        
-        while (cursor < (int)input.length()) {
-            if (isspace(input[cursor])) {
-                if(input[cursor] == '\n') line++;
-                cursor++;
-                continue;
+    void Lexer::addKeyword(std::string word, TokenType type) {
+        keywords.add(word, type);
+    }
+
+    void Lexer::prepare() {
+        if (combinedDirty) buildCombinedDFA();
+        if (!keywords.isBuilt()) keywords.build();
+    }
+
+    void Lexer::buildCombinedDFA() {
+        // Lexers with the same rules (in the same order) share one cache entry.
+        // Each rule is written as "type:length:regex" so no regex can fake a boundary.
+        std::string ruleSet;
+        for (const auto& rule : rules) {
+            ruleSet += std::to_string(rule.type) + ":" + std::to_string(rule.regex.length()) + ":" + rule.regex;
+        }
+
+        RegexCache::Entry entry = RegexCache::global().getOrCompile({ ruleSet, RegexCache::RULE_SET | RegexCache::GLUSHKOV, TOKEN_INVALID }, [&]() {
+            std::vector<NFA> ruleNFAs;
+            std::vector<TokenType> ruleTypes;
+            for (const auto& rule : rules) {
+                // Position automata: no epsilons, so determinization has nothing to close over
+                ruleNFAs.push_back(RegexParser::toNFA(RegexParser::toPostfix(rule.regex), NFAConstruction::Glushkov));
+                ruleTypes.push_back(rule.type);
             }
 
-            int bestLen = 0;
-            TokenType bestType = TOKEN_INVALID;
-            
-            for (auto& dfa : tokenDFAs) {
-                int lastFinal = -1;
-                int lastIdx = -1;
-                dfa.simulate(input.substr(cursor), lastFinal, lastIdx);
-                
-                if (lastFinal != -1) {
-                    if (lastIdx > bestLen) {
-                        bestLen = lastIdx;
-                        bestType = dfa.stateTokenMap[lastFinal];
-                    }
-                }
+            // Accepting states are tagged with the earliest rule they match, so the
+            // longest-match / declaration-order policy falls out of one DFA walk
+            CompiledRegex compiled;
+            compiled.nfa = RegexParser::combineNFAs(ruleNFAs);
+            try {
+                compiled.dfa = RegexParser::toDFA(compiled.nfa, ruleTypes);
+                compiled.dfa.minimize();
+                compiled.table = CompiledDFA::compile(compiled.dfa);
+                compiled.nfa = NFA(); // Only the fallback needs it
+            } catch (const std::length_error&) {
+                // Over the DFA budget: run the combined NFA directly instead
+                compiled.overBudget = true;
             }
+            return compiled;
+        });
 
-            if (bestLen > 0) {
-                Token t;
-                t.type = bestType;
-                t.value = input.substr(cursor, bestLen);
-                t.position = cursor;
-                t.line = line;
-                output.push_back(t);
-                cursor += bestLen;
+        if (entry->overBudget) {
+            std::vector<TokenType> ruleTypes;
+            for (const auto& rule : rules) ruleTypes.push_back(rule.type);
+            combinedDFA = DFA();
+            scanner = CompiledDFA();
+            fallbackDFA = LazyDFA(entry->nfa, ruleTypes);
+            fallbackVM = PikeVM(entry->nfa, ruleTypes);
+            useLazyDFA = true;
+            overBudget = true;
+        } else {
+            combinedDFA = entry->dfa;
+            scanner = entry->table;
+            fallbackDFA = LazyDFA();
+            fallbackVM = PikeVM();
+            useLazyDFA = false;
+            overBudget = false;
+        }
+        lazyBytes = 0;
+        combinedDirty = false;
+        combinedGraphBuilt = true;
+    }
+
+    bool Lexer::saveTables(const std::string& path) {
+        prepare();
+        if (overBudget) return false;
+
+        std::vector<LexerImage::Rule> saved;
+        for (const auto& rule : rules) saved.push_back({ rule.regex, rule.type, false });
+        for (const auto& word : keywords.getWords()) saved.push_back({ word.text, word.type, true });
+        return LexerImage::save(path, scanner, saved);
+    }
+
+    bool Lexer::loadTables(const std::string& path) {
+        LexerImage image;
+        if (!image.open(path)) return false;
+
+        rules.clear();
+        keywords = KeywordSet();
+        for (const auto& rule : image.getRules()) {
+            if (rule.keyword) keywords.add(std::string(rule.regex), rule.type);
+            else rules.push_back({ std::string(rule.regex), rule.type });
+        }
+
+        // Like the compile-time tables in init(): the graph is only built if asked for
+        scanner = image.getScanner();
+        combinedDFA = DFA();
+        fallbackDFA = LazyDFA();
+        fallbackVM = PikeVM();
+        useLazyDFA = false;
+        overBudget = false;
+        combinedDirty = false;
+        combinedGraphBuilt = false;
+        return true;
+    }
+
+    const DFA& Lexer::getCombinedDFA() {
+        if (combinedDirty || !combinedGraphBuilt) buildCombinedDFA();
+        return combinedDFA;
+    }
+
+    const CompiledDFA& Lexer::getScanner() {
+        if (combinedDirty) buildCombinedDFA();
+        return scanner;
+    }
+
+    size_t Lexer::matchToken(const char* data, size_t length, TokenType& type, bool* reachedEnd) {
+        prepare();
+        return longestMatch(data, length, type, reachedEnd);
+    }
+
+    bool Lexer::canResumeMatch() {
+        prepare();
+        return !overBudget;
+    }
+
+    Lexer::MatchWalk Lexer::beginMatch() {
+        prepare();
+        MatchWalk walk;
+        walk.ruleState = scanner.getStartState();
+        if (!keywords.empty()) walk.keywordState = keywords.getScanner().getStartState();
+        return walk;
+    }
+
+    bool Lexer::continueMatch(MatchWalk& walk, const char* data, size_t length) const {
+        if (length > walk.scanned) {
+            const char* from = data + walk.scanned;
+            size_t count = length - walk.scanned;
+            walk.ruleState = scanner.resume(walk.ruleState, walk.scanned, from, count, walk.ruleFinal, walk.ruleLength);
+            walk.keywordState = keywords.getScanner().resume(walk.keywordState, walk.scanned, from, count, walk.keywordFinal, walk.keywordLength);
+            walk.scanned = length;
+        }
+        return walk.ruleState != CompiledDFA::DEAD_STATE || walk.keywordState != CompiledDFA::DEAD_STATE;
+    }
+
+    size_t Lexer::matchResult(const MatchWalk& walk, TokenType& type) const {
+        // Same choice as longestMatch: keywords win ties
+        size_t best = 0;
+        if (walk.ruleFinal != -1 && walk.ruleLength > 0) {
+            type = scanner.tokenFor(walk.ruleFinal);
+            best = walk.ruleLength;
+        }
+        if (walk.keywordFinal != -1 && walk.keywordLength > 0 && walk.keywordLength >= best) {
+            type = keywords.getScanner().tokenFor(walk.keywordFinal);
+            best = walk.keywordLength;
+        }
+        return best;
+    }
+
+    size_t Lexer::longestMatch(const char* data, size_t length, TokenType& type, bool* reachedEnd) const {
+        size_t best = 0;
+        bool alive = false;
+
+        // 1. Rules
+        if (overBudget) {
+            TokenType lastToken;
+            size_t lastIndex;
+            if (useLazyDFA) {
+                alive = fallbackDFA.simulate(data, length, lastToken, lastIndex);
+                lazyBytes += (lastIndex != NO_MATCH && lastIndex > 0) ? lastIndex : 1;
+
+                // States rebuilt faster than they are reused: the VM is cheaper from here on
+                size_t flushes = fallbackDFA.getFlushCount();
+                if (flushes > LAZY_MAX_FLUSHES && lazyBytes < flushes * LAZY_MIN_BYTES_PER_FLUSH) {
+                    useLazyDFA = false;
+                    fallbackDFA = LazyDFA();
+                }
             } else {
-                Token t;
-                t.type = TOKEN_UNKNOWN;
-                t.value = std::string(1, input[cursor]);
-                t.position = cursor;
-                t.line = line;
-                output.push_back(t);
-                cursor++;
+                alive = fallbackVM.simulate(data, length, lastToken, lastIndex);
+            }
+            if (lastIndex != NO_MATCH && lastIndex > 0) {
+                type = lastToken;
+                best = lastIndex;
+            }
+        } else {
+            int32_t lastFinal = -1;
+            size_t lastLen = 0;
+            alive = (scanner.simulate(data, length, lastFinal, lastLen) != CompiledDFA::DEAD_STATE);
+            if (lastFinal != -1 && lastLen > 0) {
+                type = scanner.tokenFor(lastFinal);
+                best = lastLen;
+            }
+        }
+
+        // 2. Keywords win ties
+        if (!keywords.empty()) {
+            TokenType keywordType;
+            bool keywordAlive = false;
+            size_t keywordLen = keywords.longestMatch(data, length, keywordType, &keywordAlive);
+            if (keywordLen > 0 && keywordLen >= best) {
+                type = keywordType;
+                best = keywordLen;
             }
+            alive = alive || keywordAlive;
+        }
+
+        if (reachedEnd) *reachedEnd = alive;
+        return best;
+    }
+
+    size_t Lexer::scanStep(std::string_view input, size_t cursor, int& line, std::vector<TokenSpan>& output) const {
+        // C-locale whitespace only, as in StreamLexer::drain (isspace may accept
+        // bytes like 0xA0 that the kernel would not skip)
+        int newlines = 0;
+        size_t spaces = ScanKernels::skipWhitespace(input.data() + cursor, input.length() - cursor, newlines);
+        if (spaces > 0) {
+            line += newlines;
+            return cursor + spaces;
+        }
+
+        TokenType bestType = TOKEN_INVALID;
+        size_t bestLen = longestMatch(input.data() + cursor, input.length() - cursor, bestType);
+
+        if (bestLen > 0) {
+            output.push_back({ bestType, cursor, bestLen, line });
+            return cursor + bestLen;
+        }
+        // An unmatched character is one token, not one per UTF-8 byte
+        size_t unknownLen = std::max<size_t>(1, Utf8::sequenceLength(input.data() + cursor, input.length() - cursor));
+        output.push_back({ TOKEN_UNKNOWN, cursor, unknownLen, line });
+        return cursor + unknownLen;
+    }
+
+    std::vector<TokenSpan> Lexer::tokenizeSpans(std::string_view input) {
+        prepare();
+
+        std::vector<TokenSpan> output;
+        size_t cursor = 0;
+        int line = 1;
+        
+        while (cursor < input.length()) {
+            cursor = scanStep(input, cursor, line, output);
         }
         
-        Token eof; eof.type = TOKEN_EOF; eof.line = line;
-        output.push_back(eof);
+        output.push_back({ TOKEN_EOF, cursor, 0, line });
+        return output;
+    }
+
+    // Speculative scan of one chunk, started at its first byte as if that were a
+    // token boundary. Lines are counted from 0 and fixed up when stitching.
+    struct ChunkScan {
+        std::vector<TokenSpan> tokens;
+        size_t endCursor = 0; // First cursor position at or past the chunk end
+        int endLine = 0;
+    };
+
+    std::vector<TokenSpan> Lexer::tokenizeParallel(std::string_view input, unsigned threadCount) {
+        prepare();
+
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        size_t maxChunks = std::max<size_t>(1, input.length() / PARALLEL_MIN_CHUNK);
+        size_t chunkCount = std::min<size_t>(threadCount, maxChunks);
+        if (chunkCount <= 1 || overBudget) return tokenizeSpans(input); // The fallbacks' scratch state is not shareable
+
+        std::vector<size_t> bounds(chunkCount + 1);
+        for (size_t k = 0; k <= chunkCount; k++) bounds[k] = input.length() * k / chunkCount;
+
+        // 1. Every chunk is scanned independently. Scanning is a pure function of
+        // the cursor position, so once the true cursor lands on a position a chunk
+        // scan also passed through, the rest of that chunk's tokens are exact.
+        std::vector<ChunkScan> scans(chunkCount);
+        std::vector<std::thread> workers;
+        for (size_t k = 0; k < chunkCount; k++) {
+            workers.emplace_back([&, k]() {
+                ChunkScan& scan = scans[k];
+                size_t cursor = bounds[k];
+                int line = 0;
+                while (cursor < bounds[k + 1]) {
+                    cursor = scanStep(input, cursor, line, scan.tokens);
+                }
+                scan.endCursor = cursor;
+                scan.endLine = line;
+            });
+        }
+        for (auto& w : workers) w.join();
+
+        // 2. Stitch: walk chunks in order carrying the true (cursor, line)
+        auto countNewlines = [&](size_t from, size_t to) {
+            return (int)ScanKernels::countNewlines(input.data() + from, to - from);
+        };
+
+        std::vector<TokenSpan> output;
+        size_t cursor = 0;
+        int line = 1;
+
+        for (size_t k = 0; k < chunkCount; k++) {
+            const ChunkScan& scan = scans[k];
+            const auto& toks = scan.tokens;
+
+            while (cursor < bounds[k + 1]) {
+                if (cursor > scan.endCursor) break;
+
+                // First speculative token starting at or after the true cursor
+                auto next = std::lower_bound(toks.begin(), toks.end(), cursor,
+                    [](const TokenSpan& t, size_t pos) { return t.offset < pos; });
+
+                // The chunk scan passed through cursor unless cursor is strictly inside one of its tokens
+                bool inside = false;
+                if (next != toks.begin()) {
+                    const TokenSpan& prev = *(next - 1);
+                    inside = prev.offset + prev.length > cursor;
+                }
+
+                if (!inside) {
+                    size_t refPos = (next != toks.end()) ? next->offset : scan.endCursor;
+                    int refLine = (next != toks.end()) ? next->line : scan.endLine;
+                    int lineDelta = line + countNewlines(cursor, refPos) - refLine;
+
+                    for (auto it = next; it != toks.end(); ++it) {
+                        TokenSpan t = *it;
+                        t.line += lineDelta;
+                        output.push_back(t);
+                    }
+                    cursor = scan.endCursor;
+                    line = scan.endLine + lineDelta;
+                    break;
+                }
+
+                // Not in sync yet: advance the true scan one step and retry
+                cursor = scanStep(input, cursor, line, output);
+            }
+        }
+
+        // The last chunk ends at input end, but a resync-free tail may remain
+        while (cursor < input.length()) {
+            cursor = scanStep(input, cursor, line, output);
+        }
+
+        output.push_back({ TOKEN_EOF, cursor, 0, line });
+        return output;
+    }
+
+    bool Lexer::tokenizeFile(const std::string& path, MappedFile& mapping, std::vector<TokenSpan>& tokens) {
+        if (!mapping.open(path)) return false;
+        tokens = tokenizeSpans(mapping.view());
+        return true;
+    }
+
+    std::vector<Token> Lexer::tokenize(std::string_view input) {
+        std::vector<TokenSpan> spans = tokenizeSpans(input);
+
+        std::vector<Token> output;
+        output.reserve(spans.size());
+        for (const auto& span : spans) {
+            Token t;
+            t.type = span.type;
+            t.value = std::string(input.substr(span.offset, span.length));
+            t.position = (int)span.offset;
+            t.line = span.line;
+            output.push_back(t);
+        }
         return output;
     }
 }
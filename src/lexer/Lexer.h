@@ -1,15 +1,56 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
 #include "FA.h"
 #include "RegexParser.h"
+#include "CompiledDFA.h"
+#include "PikeVM.h"
+#include "LazyDFA.h"
+#include "KeywordSet.h"
+#include "MappedFile.h"
 
 namespace Automata {
 
     class Lexer {
     private:
-        std::vector<DFA> tokenDFAs;
+        struct Rule {
+            std::string regex;
+            TokenType type;
+        };
+
         // Priority order matters for resolving conflicts (e.g. keywords over identifiers)
+        std::vector<Rule> rules;
+
+        // All rules merged into one NFA and determinized once; rebuilt lazily after addRule
+        DFA combinedDFA;
+        CompiledDFA scanner; // Table form of combinedDFA that tokenize() runs
+        bool combinedDirty = true;
+        bool combinedGraphBuilt = false; // False while scanner comes from the compile-time tables
+
+        // Used instead of scanner when the rules exceed RegexParser::MAX_DFA_STATES:
+        // a lazy DFA over the combined NFA first, then the Pike VM once the lazy
+        // DFA's state cache thrashes (flushed again before LAZY_MIN_BYTES_PER_FLUSH
+        // of input). Mutable: the state cache and thread lists are scratch space
+        // reused by every match.
+        static constexpr size_t LAZY_MAX_FLUSHES = 4; // Flushes tolerated before the rate is judged
+        static constexpr size_t LAZY_MIN_BYTES_PER_FLUSH = 256 * 1024;
+        mutable LazyDFA fallbackDFA;
+        mutable PikeVM fallbackVM;
+        mutable bool useLazyDFA = false;
+        mutable size_t lazyBytes = 0; // Input tokenized through fallbackDFA
+        bool overBudget = false;
+
+        // Literal words checked next to the rules; a keyword at least as long as
+        // the rule match wins
+        KeywordSet keywords;
+
+        void buildCombinedDFA();
+        void prepare(); // Rebuilds whatever addRule / addKeyword left stale
+
+        // Shared scan loop pieces; const so worker threads can use them concurrently
+        size_t longestMatch(const char* data, size_t length, TokenType& type, bool* reachedEnd = nullptr) const;
+        size_t scanStep(std::string_view input, size_t cursor, int& line, std::vector<TokenSpan>& output) const;
         
     public:
         // Initialize with default patterns
@@ -17,13 +58,72 @@ namespace Automata {
         
         // Add a specific regex rule
         void addRule(std::string regex, TokenType type);
+
+        // Add a reserved word or operator. It beats any rule match of the same
+        // length (so "if" is not an identifier, while "iffy" still is) and any
+        // shorter one ("==" over "="). Cheap to add by the hundred: all keywords
+        // share one minimized trie, walked once per token.
+        void addKeyword(std::string word, TokenType type = TOKEN_KEYWORD);
         
-        // Tokenize a full input string
-        std::vector<Token> tokenize(std::string input);
+        // Tokenize a full input string (each Token owns a copy of its lexeme)
+        std::vector<Token> tokenize(std::string_view input);
+
+        // Zero-copy tokenize: spans point back into input, nothing is copied
+        std::vector<TokenSpan> tokenizeSpans(std::string_view input);
+
+        // Same token stream as tokenizeSpans, computed by splitting input into one
+        // chunk per thread (0 = hardware concurrency) and stitching the results.
+        // Inputs shorter than PARALLEL_MIN_CHUNK per thread, and rule sets running
+        // on the over-budget fallback, use one thread.
+        static constexpr size_t PARALLEL_MIN_CHUNK = 64 * 1024;
+        std::vector<TokenSpan> tokenizeParallel(std::string_view input, unsigned threadCount = 0);
+
+        // Maps path read-only into mapping and tokenizes it in place; the spans
+        // refer into mapping.view(). Returns false if the file cannot be mapped.
+        bool tokenizeFile(const std::string& path, MappedFile& mapping, std::vector<TokenSpan>& tokens);
+
+        // Writes the compiled rules and keywords to path as a LexerImage.
+        // Returns false if it cannot be written, or if the rules exceed the DFA
+        // budget and so have no table to save.
+        bool saveTables(const std::string& path);
+
+        // Replaces every rule and keyword with the ones saved in path. The scanner
+        // runs straight from the mapped file, so nothing is compiled (keywords are
+        // rebuilt from their words on first use). Returns false and leaves the
+        // lexer unchanged if the file is missing, damaged or from another version.
+        bool loadTables(const std::string& path);
+
+        // Longest rule match at data (0 if none); type receives the winning rule's token.
+        // reachedEnd is set when the DFA was still alive at data + length, i.e. more
+        // input could still extend the match (used by StreamLexer at chunk edges)
+        size_t matchToken(const char* data, size_t length, TokenType& type, bool* reachedEnd = nullptr);
         
-        // Helper to merge multiple DFAs into one combined NFA/DFA (Optional for visualization)
-        // For actual lexing, running independent DFAs or a combined DFA is a choice. 
-        // We will run 'longest match' across all patterns.
+        // A matchToken that StreamLexer continues chunk by chunk, so a token
+        // spanning many chunks is walked once instead of from its first byte
+        // after every chunk. data always points at the token's first byte; each
+        // continueMatch walks only the bytes past walk.scanned. Only the table
+        // scanner can be resumed: canResumeMatch() is false for rule sets on the
+        // over-budget fallback.
+        struct MatchWalk {
+            int32_t ruleState = CompiledDFA::DEAD_STATE;
+            int32_t ruleFinal = -1;
+            size_t ruleLength = 0;
+            int32_t keywordState = CompiledDFA::DEAD_STATE;
+            int32_t keywordFinal = -1;
+            size_t keywordLength = 0;
+            size_t scanned = 0; // Bytes walked from the token start
+        };
+        bool canResumeMatch();
+        MatchWalk beginMatch();
+        // Returns true while more input could still extend the match (reachedEnd)
+        bool continueMatch(MatchWalk& walk, const char* data, size_t length) const;
+        // Longest match over the bytes walked so far, same as matchToken over them
+        size_t matchResult(const MatchWalk& walk, TokenType& type) const;
+
+        // Combined automaton of every rule (longest match, earlier rule wins ties).
+        // Empty when the rules are too large to determinize and a fallback is used.
+        const DFA& getCombinedDFA();
+        const CompiledDFA& getScanner();
     };
 
 }
@@ -0,0 +1,183 @@
+#include "LexerImage.h"
+#include <cstring>
+#include <fstream>
+
+namespace Automata {
+
+    namespace {
+        const char MAGIC[8] = { 'A', 'U', 'T', 'O', 'D', 'F', 'A', '\n' };
+        const uint32_t BYTE_ORDER_MARK = 0x01020304;
+        const uint32_t RULE_KEYWORD = 1;
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byteOrder;      // BYTE_ORDER_MARK as stored by the writer
+            uint32_t headerSize;     // sizeof(Header)
+            uint32_t loopRecordSize; // sizeof(ScanKernels::ByteRanges)
+            uint64_t fileSize;
+            uint64_t checksum;       // FNV-1a 64 of bytes [headerSize, fileSize)
+            int32_t stateCount;
+            int32_t classCount;
+            int32_t startState;
+            uint32_t ruleCount;
+            uint64_t byteClassOffset;
+            uint64_t tableOffset;
+            uint64_t acceptOffset;
+            uint64_t selfLoopOffset;
+            uint64_t ruleOffset;
+            uint64_t textOffset;
+        };
+        static_assert(sizeof(Header) == 104, "Header must have no padding");
+
+        struct RuleRecord {
+            int32_t type;
+            uint32_t flags;      // RULE_KEYWORD
+            uint64_t textOffset; // From the start of the text section
+            uint64_t textLength;
+        };
+        static_assert(sizeof(RuleRecord) == 24, "RuleRecord must have no padding");
+
+        uint64_t fnv1a(const unsigned char* data, size_t length) {
+            uint64_t h = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < length; i++) {
+                h ^= data[i];
+                h *= 0x100000001b3ull;
+            }
+            return h;
+        }
+
+        // Appends bytes at the next 8-byte boundary; returns their offset
+        uint64_t appendSection(std::string& out, const void* data, size_t length) {
+            out.resize((out.size() + 7) & ~(size_t)7, '\0');
+            uint64_t offset = out.size();
+            if (length > 0) out.append((const char*)data, length);
+            return offset;
+        }
+
+        bool inside(uint64_t offset, uint64_t length, uint64_t fileSize, size_t alignment) {
+            return offset % alignment == 0 && offset <= fileSize && length <= fileSize - offset;
+        }
+    }
+
+    bool LexerImage::save(const std::string& path, const CompiledDFA& scanner, const std::vector<Rule>& rules) {
+        Header h = {};
+        std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+        h.version = VERSION;
+        h.byteOrder = BYTE_ORDER_MARK;
+        h.headerSize = sizeof(Header);
+        h.loopRecordSize = sizeof(ScanKernels::ByteRanges);
+        h.stateCount = scanner.getStateCount();
+        h.classCount = scanner.getClassCount();
+        h.startState = scanner.getStartState();
+        h.ruleCount = (uint32_t)rules.size();
+
+        // 1. Rule records and their text
+        std::vector<RuleRecord> records;
+        std::string text;
+        for (const auto& rule : rules) {
+            records.push_back({ (int32_t)rule.type, rule.keyword ? RULE_KEYWORD : 0, text.size(), rule.regex.size() });
+            text.append(rule.regex.data(), rule.regex.size());
+        }
+
+        // 2. Sections, in the order of the layout comment
+        size_t states = (size_t)h.stateCount;
+        std::string out(sizeof(Header), '\0');
+        h.byteClassOffset = appendSection(out, scanner.getByteClasses(), 256);
+        h.tableOffset = appendSection(out, scanner.getTable(), scanner.getTableBytes());
+        h.acceptOffset = appendSection(out, scanner.getAcceptTokens(), states * sizeof(int32_t));
+        h.selfLoopOffset = appendSection(out, scanner.getSelfLoops(), states * sizeof(ScanKernels::ByteRanges));
+        h.ruleOffset = appendSection(out, records.data(), records.size() * sizeof(RuleRecord));
+        h.textOffset = appendSection(out, text.data(), text.size());
+
+        // 3. Header last: it covers the finished body
+        h.fileSize = out.size();
+        h.checksum = fnv1a((const unsigned char*)out.data() + sizeof(Header), out.size() - sizeof(Header));
+        std::memcpy(&out[0], &h, sizeof(Header));
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(out.data(), (std::streamsize)out.size());
+        return (bool)file;
+    }
+
+    bool LexerImage::fail(const std::string& message) {
+        error = message;
+        file.reset();
+        scanner = CompiledDFA();
+        rules.clear();
+        return false;
+    }
+
+    bool LexerImage::open(const std::string& path, bool verify) {
+        error.clear();
+        rules.clear();
+        file = std::make_shared<MappedFile>();
+        if (!file->open(path, MappedFile::Access::Random)) return fail("Cannot map " + path);
+
+        // 1. Header: same format version and platform
+        const char* base = file->data();
+        uint64_t size = file->size();
+        if (size < sizeof(Header)) return fail("Not a lexer image (too short)");
+        const Header& h = *(const Header*)base;
+        if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) return fail("Not a lexer image");
+        if (h.version != VERSION) return fail("Lexer image version " + std::to_string(h.version) + ", expected " + std::to_string(VERSION));
+        if (h.byteOrder != BYTE_ORDER_MARK || h.headerSize != sizeof(Header) || h.loopRecordSize != sizeof(ScanKernels::ByteRanges)) {
+            return fail("Lexer image was written on an incompatible platform");
+        }
+        if (h.fileSize != size) return fail("Lexer image is truncated");
+
+        // 2. Sections inside the file and properly aligned
+        uint64_t states = (uint64_t)h.stateCount;
+        if (h.stateCount < 1 || h.classCount < 1 || h.classCount > 256 || h.startState < 0 || h.startState >= h.stateCount) {
+            return fail("Lexer image has an invalid table shape");
+        }
+        uint64_t tableBytes = states * (uint64_t)h.classCount * sizeof(int32_t);
+        if (!inside(h.byteClassOffset, 256, size, 1) ||
+            !inside(h.tableOffset, tableBytes, size, alignof(int32_t)) ||
+            !inside(h.acceptOffset, states * sizeof(int32_t), size, alignof(int32_t)) ||
+            !inside(h.selfLoopOffset, states * sizeof(ScanKernels::ByteRanges), size, alignof(ScanKernels::ByteRanges)) ||
+            !inside(h.ruleOffset, (uint64_t)h.ruleCount * sizeof(RuleRecord), size, alignof(RuleRecord)) ||
+            h.textOffset > size) {
+            return fail("Lexer image sections are out of bounds");
+        }
+
+        const unsigned char* byteClass = (const unsigned char*)base + h.byteClassOffset;
+        const int32_t* table = (const int32_t*)(base + h.tableOffset);
+        for (int b = 0; b < 256; b++) {
+            if (byteClass[b] >= h.classCount) return fail("Lexer image has an invalid byte class");
+        }
+
+        // 3. Optional checksum over everything after the header
+        if (verify && fnv1a((const unsigned char*)base + sizeof(Header), size - sizeof(Header)) != h.checksum) {
+            return fail("Lexer image checksum mismatch");
+        }
+
+        // 4. Table contents the scanner indexes with: transition targets,
+        // accept tokens and self-loop counts. Always checked, so a damaged or
+        // hostile image is rejected instead of read out of bounds.
+        for (uint64_t i = 0; i < states * (uint64_t)h.classCount; i++) {
+            if (table[i] < 0 || table[i] >= h.stateCount) return fail("Lexer image has an invalid transition");
+        }
+        const int32_t* accept = (const int32_t*)(base + h.acceptOffset);
+        const ScanKernels::ByteRanges* loops = (const ScanKernels::ByteRanges*)(base + h.selfLoopOffset);
+        for (uint64_t s = 0; s < states; s++) {
+            if (accept[s] < -1 || accept[s] > TOKEN_EOF) return fail("Lexer image has an invalid accept token");
+            if (loops[s].count < 0 || loops[s].count > ScanKernels::MAX_RUN_RANGES) return fail("Lexer image has an invalid self-loop");
+        }
+
+        // 5. Rules: views into the text section
+        const RuleRecord* records = (const RuleRecord*)(base + h.ruleOffset);
+        const char* text = base + h.textOffset;
+        uint64_t textSize = size - h.textOffset;
+        for (uint32_t i = 0; i < h.ruleCount; i++) {
+            const RuleRecord& r = records[i];
+            if (r.textOffset > textSize || r.textLength > textSize - r.textOffset) return fail("Lexer image rule text is out of bounds");
+            if (r.type < 0 || r.type > TOKEN_EOF) return fail("Lexer image has an invalid rule token");
+            rules.push_back({ std::string_view(text + r.textOffset, r.textLength), (TokenType)r.type, (r.flags & RULE_KEYWORD) != 0 });
+        }
+
+        scanner = CompiledDFA::view(h.stateCount, h.classCount, h.startState, byteClass, table, accept, loops, file);
+        return true;
+    }
+
+}
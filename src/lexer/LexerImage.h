@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FA.h"
+#include "CompiledDFA.h"
+#include "MappedFile.h"
+
+namespace Automata {
+
+    // Binary file holding a compiled lexer: the CompiledDFA arrays (byte
+    // classes, transition table, accept -> TokenType, self-loop ranges) and the
+    // rules and keywords it was built from.
+    //
+    // Every section sits at an 8-byte aligned offset in exactly the layout
+    // CompiledDFA uses in memory, so open() maps the file and points the scanner
+    // straight at it: no parsing, no copies, no pointer fix-up. The header
+    // records the format version, the byte order and record sizes of the
+    // machine that wrote it, and an FNV-1a checksum of everything after it. A
+    // file from another version or platform is rejected, not converted.
+    //
+    // Layout: Header | byte classes [256] | table [states * classes] int32 |
+    //         accept [states] int32 | self-loops [states] ByteRanges |
+    //         rules [ruleCount] RuleRecord | rule text
+    class LexerImage {
+    public:
+        static constexpr uint32_t VERSION = 1;
+
+        struct Rule {
+            std::string_view regex; // The literal word for a keyword
+            TokenType type;
+            bool keyword;
+        };
+
+        // Writes scanner and rules to path. Returns false if the file cannot be written.
+        static bool save(const std::string& path, const CompiledDFA& scanner, const std::vector<Rule>& rules);
+
+        // Maps path and checks the header, the section bounds and every value the
+        // scanner indexes with (transition targets, accept and rule tokens,
+        // self-loop counts). verify adds the checksum over the whole file; skip
+        // it for images you wrote yourself. Returns false (see getError) if the
+        // file is missing, from another version or platform, or damaged.
+        bool open(const std::string& path, bool verify = true);
+
+        // The scanner keeps the mapping alive, so it may outlive this object
+        const CompiledDFA& getScanner() const { return scanner; }
+        const std::vector<Rule>& getRules() const { return rules; } // Views into the mapping
+        const std::string& getError() const { return error; }
+
+    private:
+        std::shared_ptr<MappedFile> file;
+        CompiledDFA scanner;
+        std::vector<Rule> rules;
+        std::string error;
+
+        bool fail(const std::string& message);
+    };
+
+}
@@ -0,0 +1,142 @@
+#include "MappedFile.h"
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Automata {
+
+#ifdef _WIN32
+    MappedFile::MappedFile() : base(nullptr), length(0), opened(false), fileHandle(nullptr), mappingHandle(nullptr) {}
+#else
+    MappedFile::MappedFile() : base(nullptr), length(0), opened(false) {}
+#endif
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept : MappedFile() {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            std::swap(base, other.base);
+            std::swap(length, other.length);
+            std::swap(opened, other.opened);
+#ifdef _WIN32
+            std::swap(fileHandle, other.fileHandle);
+            std::swap(mappingHandle, other.mappingHandle);
+#endif
+        }
+        return *this;
+    }
+
+#ifdef _WIN32
+    bool MappedFile::open(const std::string& path, Access access) {
+        close();
+
+        DWORD hint = (access == Access::Sequential) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | hint, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            return false;
+        }
+
+        // Empty files cannot be mapped; expose them as an empty view
+        if (fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            opened = true;
+            return true;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == NULL) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        fileHandle = file;
+        mappingHandle = mapping;
+        base = (const char*)view;
+        length = (size_t)fileSize.QuadPart;
+        opened = true;
+        return true;
+    }
+
+    void MappedFile::close() {
+        if (base) UnmapViewOfFile(base);
+        if (mappingHandle) CloseHandle((HANDLE)mappingHandle);
+        if (fileHandle) CloseHandle((HANDLE)fileHandle);
+        base = nullptr;
+        length = 0;
+        opened = false;
+        fileHandle = nullptr;
+        mappingHandle = nullptr;
+    }
+#else
+    bool MappedFile::open(const std::string& path, Access access) {
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        // Empty files cannot be mapped; expose them as an empty view
+        if (st.st_size == 0) {
+            ::close(fd);
+            opened = true;
+            return true;
+        }
+
+        void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping keeps its own reference
+        if (view == MAP_FAILED) return false;
+
+        if (access == Access::Sequential) {
+            madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+        } else {
+            madvise(view, (size_t)st.st_size, MADV_RANDOM);
+            madvise(view, (size_t)st.st_size, MADV_WILLNEED);
+        }
+
+        base = (const char*)view;
+        length = (size_t)st.st_size;
+        opened = true;
+        return true;
+    }
+
+    void MappedFile::close() {
+        if (base) munmap((void*)base, length);
+        base = nullptr;
+        length = 0;
+        opened = false;
+    }
+#endif
+
+}
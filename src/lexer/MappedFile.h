@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+namespace Automata {
+
+    // Read-only memory mapping of a whole file. The view stays valid until the
+    // MappedFile is closed or destroyed, so offset-based tokens can refer into it.
+    class MappedFile {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        // How the mapping will be read, passed to the kernel as a paging hint
+        enum class Access {
+            Sequential, // Front to back once (source files): aggressive readahead
+            Random      // Looked up anywhere for a long time (DFA tables): load now, no readahead
+        };
+
+        // Maps path read-only with the given access hint.
+        // Returns false if the file cannot be opened or mapped.
+        bool open(const std::string& path, Access access = Access::Sequential);
+        void close();
+
+        bool isOpen() const { return opened; }
+        const char* data() const { return base; }
+        size_t size() const { return length; }
+        std::string_view view() const { return std::string_view(base, length); }
+
+    private:
+        const char* base;
+        size_t length;
+        bool opened;
+#ifdef _WIN32
+        void* fileHandle;
+        void* mappingHandle;
+#endif
+    };
+
+}
@@ -0,0 +1,98 @@
+#include "PikeVM.h"
+
+namespace Automata {
+
+    PikeVM::PikeVM() : startState(-1) {}
+
+    PikeVM::PikeVM(const NFA& nfa, TokenType type) : PikeVM(nfa, std::vector<TokenType>{ type }) {}
+
+    PikeVM::PikeVM(const NFA& nfa, const std::vector<TokenType>& types) : ruleTypes(types), startState(-1) {
+        const int n = (int)nfa.states.size();
+        if (n == 0) return;
+
+        // 1. Flatten transitions into two CSR-style arrays
+        epsBegin.assign(n + 1, 0);
+        edgeBegin.assign(n + 1, 0);
+        for (int s = 0; s < n; s++) {
+            epsBegin[s] = (int)epsTargets.size();
+            edgeBegin[s] = (int)edges.size();
+            for (const auto& t : nfa.states[s].transitions) {
+                if (t.isEpsilon()) epsTargets.push_back(t.targetStateId);
+                else edges.push_back({ t.firstByte(), t.lastByte(), t.targetStateId });
+            }
+        }
+        epsBegin[n] = (int)epsTargets.size();
+        edgeBegin[n] = (int)edges.size();
+
+        // 2. Accepting states
+        ruleOfState = nfa.acceptingRules();
+
+        current.resize(n);
+        next.resize(n);
+        stack.reserve(n);
+        startState = nfa.startStateId;
+    }
+
+    void PikeVM::addThread(SparseSet& list, int s) {
+        if (list.contains(s)) return;
+        list.insert(s);
+        stack.push_back(s);
+
+        while (!stack.empty()) {
+            int u = stack.back(); stack.pop_back();
+            for (int i = epsBegin[u]; i < epsBegin[u + 1]; i++) {
+                int v = epsTargets[i];
+                if (list.contains(v)) continue;
+                list.insert(v);
+                stack.push_back(v);
+            }
+        }
+    }
+
+    int PikeVM::acceptingToken(const SparseSet& list) const {
+        int best = -1;
+        for (int i = 0; i < list.size(); i++) {
+            int rule = ruleOfState[list[i]];
+            if (rule != -1 && (best == -1 || rule < best)) best = rule;
+        }
+        if (best == -1) return -1;
+        return best < (int)ruleTypes.size() ? ruleTypes[best] : TOKEN_INVALID;
+    }
+
+    bool PikeVM::simulate(const char* data, size_t length, TokenType& lastToken, size_t& lastInputIndex) {
+        lastToken = TOKEN_INVALID;
+        lastInputIndex = NO_MATCH;
+        if (empty()) return false;
+
+        current.clear();
+        addThread(current, startState);
+        int token = acceptingToken(current);
+        if (token != -1) {
+            lastToken = (TokenType)token;
+            lastInputIndex = 0;
+        }
+
+        for (size_t i = 0; i < length; i++) {
+            unsigned char b = (unsigned char)data[i];
+
+            // Advance every thread over b
+            next.clear();
+            for (int k = 0; k < current.size(); k++) {
+                int s = current[k];
+                for (int e = edgeBegin[s]; e < edgeBegin[s + 1]; e++) {
+                    if (b >= edges[e].lo && b <= edges[e].hi) addThread(next, edges[e].target);
+                }
+            }
+            std::swap(current, next);
+            if (current.size() == 0) return false;
+
+            token = acceptingToken(current);
+            if (token != -1) {
+                lastToken = (TokenType)token;
+                lastInputIndex = i + 1;
+            }
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "FA.h"
+
+namespace Automata {
+
+    // Runs an epsilon-NFA (Thompson, Glushkov or a combined rule set) directly,
+    // without determinizing it (Pike VM style).
+    // Every live NFA state is a thread; each input byte advances all threads in
+    // lock step, so matching is O(input * NFA states) with no compile step and
+    // no risk of DFA blow-up. Thread lists are sparse sets sized once per
+    // automaton, so nothing is allocated per byte.
+    //
+    // Used when the DFA budget is exceeded (Lexer) and for one-off matches in
+    // the regex playground.
+    class PikeVM {
+    public:
+        PikeVM();
+        PikeVM(const NFA& nfa, TokenType type);
+        // Combined multi-rule NFA (RegexParser::combineNFAs); the earliest rule wins
+        PikeVM(const NFA& nfa, const std::vector<TokenType>& ruleTypes);
+
+        // Anchored longest match, same results as DFA::simulate on the
+        // determinized NFA. lastInputIndex is the match length (a size_t, so
+        // mapped inputs past 2 GiB work), NO_MATCH if no prefix matched.
+        // Returns false if every thread died before the end of input.
+        bool simulate(const char* data, size_t length, TokenType& lastToken, size_t& lastInputIndex);
+        bool simulate(const std::string& input, TokenType& lastToken, size_t& lastInputIndex) {
+            return simulate(input.data(), input.length(), lastToken, lastInputIndex);
+        }
+
+        bool empty() const { return startState < 0; }
+        int getStateCount() const { return (int)ruleOfState.size(); }
+
+    private:
+        // Set of NFA states with O(1) insert / membership / clear and
+        // insertion-order iteration (Briggs & Torczon)
+        class SparseSet {
+        public:
+            void resize(int capacity) { dense.assign(capacity, 0); sparse.assign(capacity, 0); count = 0; }
+            void clear() { count = 0; }
+            bool contains(int s) const { int i = sparse[s]; return i < count && dense[i] == s; }
+            void insert(int s) { sparse[s] = count; dense[count++] = s; }
+            int size() const { return count; }
+            int operator[](int i) const { return dense[i]; }
+        private:
+            std::vector<int> dense;
+            std::vector<int> sparse;
+            int count = 0;
+        };
+
+        struct Edge {
+            unsigned char lo;
+            unsigned char hi;
+            int target;
+        };
+
+        // Flattened program: per state, its epsilon targets and byte edges
+        std::vector<int> epsBegin;   // stateCount + 1 offsets into epsTargets
+        std::vector<int> epsTargets;
+        std::vector<int> edgeBegin;  // stateCount + 1 offsets into edges
+        std::vector<Edge> edges;
+        std::vector<int> ruleOfState; // Accepting rule per state, -1 if none
+        std::vector<TokenType> ruleTypes;
+        int startState;
+
+        // Preallocated thread lists and closure stack
+        SparseSet current;
+        SparseSet next;
+        std::vector<int> stack;
+
+        // Adds s and everything epsilon-reachable from it to list
+        void addThread(SparseSet& list, int s);
+        // Token of the best rule accepted by list, -1 if none
+        int acceptingToken(const SparseSet& list) const;
+    };
+
+}
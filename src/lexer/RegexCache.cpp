@@ -0,0 +1,100 @@
+#include "RegexCache.h"
+
+namespace Automata {
+
+    size_t CompiledRegex::approxBytes() const {
+        size_t bytes = sizeof(CompiledRegex) + table.getTableBytes();
+        for (const AutomatonBase* fa : { (const AutomatonBase*)&nfa, (const AutomatonBase*)&dfa }) {
+            for (const auto& s : fa->states) {
+                // std::set nodes cost roughly four words each
+                bytes += sizeof(State) + s.transitions.size() * sizeof(Transition) + s.nfaStateIds.size() * 4 * sizeof(void*);
+            }
+        }
+        return bytes;
+    }
+
+    size_t RegexCache::KeyHash::operator()(const Key& key) const {
+        size_t h = std::hash<std::string>()(key.pattern);
+        h ^= ((size_t)key.flags << 8 | (size_t)key.type) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        return h;
+    }
+
+    RegexCache::RegexCache(size_t maxEntries, size_t maxBytes)
+        : maxEntries(maxEntries), maxBytes(maxBytes) {}
+
+    RegexCache& RegexCache::global() {
+        static RegexCache cache;
+        return cache;
+    }
+
+    RegexCache::Entry RegexCache::find(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            stats.misses++;
+            return nullptr;
+        }
+        stats.hits++;
+        order.splice(order.begin(), order, it->second);
+        return it->second->value;
+    }
+
+    RegexCache::Entry RegexCache::getOrCompile(const Key& key, const std::function<CompiledRegex()>& compile) {
+        if (Entry hit = find(key)) return hit;
+
+        // 1. Compile without the lock
+        Entry value = std::make_shared<const CompiledRegex>(compile());
+        size_t bytes = value->approxBytes() + key.pattern.size();
+
+        // 2. Store, unless another thread got there first
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            order.splice(order.begin(), order, it->second);
+            return it->second->value;
+        }
+        insert(key, value, bytes);
+        return value;
+    }
+
+    void RegexCache::insert(const Key& key, Entry value, size_t bytes) {
+        if (maxEntries == 0 || bytes > maxBytes) return; // Would evict everything and still not fit
+        order.push_front({ key, std::move(value), bytes });
+        index[key] = order.begin();
+        stats.bytes += bytes;
+        stats.entries = order.size();
+        evict();
+    }
+
+    void RegexCache::evict() {
+        while (!order.empty() && (order.size() > maxEntries || stats.bytes > maxBytes)) {
+            const Slot& last = order.back();
+            stats.bytes -= last.bytes;
+            stats.evictions++;
+            index.erase(last.key);
+            order.pop_back();
+        }
+        stats.entries = order.size();
+    }
+
+    void RegexCache::clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.clear();
+        index.clear();
+        stats.entries = 0;
+        stats.bytes = 0;
+    }
+
+    void RegexCache::setLimits(size_t newMaxEntries, size_t newMaxBytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxEntries = newMaxEntries;
+        maxBytes = newMaxBytes;
+        evict();
+    }
+
+    RegexCache::Stats RegexCache::getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "FA.h"
+#include "CompiledDFA.h"
+
+namespace Automata {
+
+    // Everything compiled from one pattern. Each user fills in the parts it
+    // needs (createDFA only the DFA, the playground all of them, ...).
+    struct CompiledRegex {
+        NFA nfa;
+        DFA dfa;
+        CompiledDFA table;
+        int statesBeforeMinimize = 0;
+        bool overBudget = false; // DFA budget exceeded; only nfa is usable
+
+        size_t approxBytes() const;
+    };
+
+    // Process-wide LRU cache of compiled regexes, keyed by (pattern, flags, type).
+    // Entries are immutable and shared, so a hit costs one lookup and no copy
+    // unless the caller makes one. Bounded by entry count and by approximate
+    // memory; the least recently used entries go first.
+    //
+    // Thread-safe. Compilation runs outside the lock, so a slow pattern does not
+    // block lookups of others; if two threads miss on the same key at once, both
+    // compile and the first result stored wins.
+    class RegexCache {
+    public:
+        // Flags: which pipeline built the entry. Part of the key, so one pattern
+        // compiled for different users is kept apart.
+        static constexpr uint32_t GLUSHKOV = 1;   // NFAConstruction::Glushkov
+        static constexpr uint32_t RULE_SET = 2;   // pattern encodes a whole Lexer rule set
+        static constexpr uint32_t PLAYGROUND = 4; // Optimized + minimized for display
+
+        static constexpr size_t DEFAULT_MAX_ENTRIES = 512;
+        static constexpr size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+        struct Key {
+            std::string pattern;
+            uint32_t flags;
+            TokenType type;
+
+            bool operator==(const Key& other) const {
+                return flags == other.flags && type == other.type && pattern == other.pattern;
+            }
+        };
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+            size_t entries = 0;
+            size_t bytes = 0;
+        };
+
+        using Entry = std::shared_ptr<const CompiledRegex>;
+
+        explicit RegexCache(size_t maxEntries = DEFAULT_MAX_ENTRIES, size_t maxBytes = DEFAULT_MAX_BYTES);
+
+        // The instance shared by RegexParser, Lexer and the GUI
+        static RegexCache& global();
+
+        // Cached entry for key, or the result of compile() (stored, then returned).
+        // Exceptions from compile() propagate and nothing is stored.
+        Entry getOrCompile(const Key& key, const std::function<CompiledRegex()>& compile);
+
+        // nullptr on a miss; counts towards the statistics like getOrCompile
+        Entry find(const Key& key);
+
+        void clear();
+        void setLimits(size_t maxEntries, size_t maxBytes);
+        Stats getStats() const;
+
+    private:
+        struct KeyHash {
+            size_t operator()(const Key& key) const;
+        };
+
+        struct Slot {
+            Key key;
+            Entry value;
+            size_t bytes;
+        };
+
+        void insert(const Key& key, Entry value, size_t bytes); // Caller holds mutex
+        void evict();                                           // Caller holds mutex
+
+        mutable std::mutex mutex;
+        std::list<Slot> order; // Most recently used first
+        std::unordered_map<Key, std::list<Slot>::iterator, KeyHash> index;
+        size_t maxEntries;
+        size_t maxBytes;
+        Stats stats;
+    };
+
+}
@@ -1,10 +1,18 @@
 #include "RegexParser.h"
+#include "StateSet.h"
+#include "Utf8.h"
+#include "RegexCache.h"
 #include <stack>
 #include <queue>
 #include <set>
 #include <algorithm>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <bitset>
+#include <cctype>
+#include <stdexcept>
 
 namespace Automata {
 
@@ -20,8 +28,369 @@ namespace Automata {
         return c == '*' || c == '+' || c == '|' || c == '.' || c == '(' || c == ')';
     }
 
-    std::string RegexParser::preprocessRegex(const std::string& regex) {
+    // Character classes. Byte 0 is never part of a class: '\0' labels epsilon edges.
+
+    // \d \w \s and their complements \D \W \S; false if e is not a class escape
+    bool escapeClass(char e, std::bitset<256>& set) {
+        std::bitset<256> members;
+        switch (tolower((unsigned char)e)) {
+            case 'd':
+                for (int b = '0'; b <= '9'; b++) members.set(b);
+                break;
+            case 'w':
+                for (int b = 0; b < 256; b++) if (isalnum(b) && b < 128) members.set(b);
+                members.set('_');
+                break;
+            case 's':
+                for (char b : std::string(" \t\n\r\f\v")) members.set((unsigned char)b);
+                break;
+            default:
+                return false;
+        }
+        if (isupper((unsigned char)e)) {
+            members.flip();
+            members.reset(0);
+        }
+        set |= members;
+        return true;
+    }
+
+    // \n \t \r are control characters; any other escaped character stands for itself
+    char escapeLiteral(char e) {
+        if (e == 'n') return '\n';
+        if (e == 't') return '\t';
+        if (e == 'r') return '\r';
+        return e;
+    }
+
+    int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // Numeric escape at regex[pos] (the backslash), ending before end:
+    // \xHH (a byte), \uHHHH or \u{H...} (a code point). next is the index after it.
+    bool numericEscape(const std::string& regex, size_t pos, size_t end, uint32_t& value, size_t& next, bool& isByte) {
+        if (pos + 1 >= end || regex[pos] != '\\') return false;
+        char kind = regex[pos + 1];
+        size_t i = pos + 2;
+        value = 0;
+
+        auto digits = [&](size_t count) {
+            for (size_t k = 0; k < count; k++, i++) {
+                if (i >= end || hexValue(regex[i]) < 0) return false;
+                value = value * 16 + hexValue(regex[i]);
+            }
+            return true;
+        };
+
+        if (kind == 'x') {
+            if (!digits(2)) return false;
+            isByte = true;
+        } else if (kind == 'u' && i < end && regex[i] == '{') {
+            i++;
+            size_t start = i;
+            while (i < end && hexValue(regex[i]) >= 0 && i - start < 6) value = value * 16 + hexValue(regex[i++]);
+            if (i == start || i >= end || regex[i] != '}') return false;
+            i++;
+            isByte = false;
+        } else if (kind == 'u') {
+            if (!digits(4)) return false;
+            isByte = false;
+        } else {
+            return false;
+        }
+
+        if (!isByte && value > Utf8::MAX_CODE_POINT) {
+            throw std::invalid_argument("Regex code point above U+10FFFF");
+        }
+        next = i;
+        return true;
+    }
+
+    // Index of the ']' closing the bracket expression that opens at regex[open], or npos.
+    // A ']' right after '[' or '[^' is a literal member.
+    size_t classEnd(const std::string& regex, size_t open) {
+        size_t i = open + 1;
+        if (i < regex.length() && regex[i] == '^') i++;
+        if (i < regex.length() && regex[i] == ']') i++;
+        for (; i < regex.length(); i++) {
+            if (regex[i] == '\\') i++;
+            else if (regex[i] == ']') return i;
+        }
+        return std::string::npos;
+    }
+
+    // Bytes matched by the bracket expression regex[open..close]
+    std::bitset<256> parseClass(const std::string& regex, size_t open, size_t close) {
+        std::bitset<256> set;
+        size_t i = open + 1;
+        bool negate = (regex[i] == '^');
+        if (negate) i++;
+
+        // One member: returns its byte, or -1 after adding a class escape to set
+        auto member = [&](size_t& pos) -> int {
+            uint32_t value; size_t next; bool isByte;
+            if (numericEscape(regex, pos, close, value, next, isByte) && isByte) {
+                pos = next;
+                return (int)value;
+            }
+            if (regex[pos] == '\\' && pos + 1 < close) {
+                pos++;
+                if (escapeClass(regex[pos], set)) { pos++; return -1; }
+                return (unsigned char)escapeLiteral(regex[pos++]);
+            }
+            return (unsigned char)regex[pos++];
+        };
+
+        while (i < close) {
+            int lo = member(i);
+            if (lo < 0) continue;
+
+            // Range a-z; a '-' at either end of the class is a literal
+            if (i + 1 < close && regex[i] == '-') {
+                i++;
+                int hi = member(i);
+                if (hi >= 0) {
+                    if (hi < lo) std::swap(lo, hi);
+                    for (int b = lo; b <= hi; b++) set.set(b);
+                    continue;
+                }
+                set.set('-'); // [a-\d]: the '-' is literal
+            }
+            set.set(lo);
+        }
+
+        if (negate) set.flip();
+        set.reset(0);
+        return set;
+    }
+
+    // --- Unicode ---
+    // Code points outside ASCII never reach the automata as such: before
+    // preprocessing, every \\u escape, non-ASCII UTF-8 literal and bracket
+    // expression mentioning either is rewritten into plain byte-class atoms
+    // that match its UTF-8 encodings, e.g. [\\u{400}-\\u{4FF}] -> ([\\xD0-\\xD3][\\x80-\\xBF]).
+
+    using CodePointRanges = std::vector<std::pair<uint32_t, uint32_t>>;
+
+    std::string hexByte(unsigned char b) {
+        const char* digits = "0123456789ABCDEF";
+        return std::string("\\x") + digits[b >> 4] + digits[b & 15];
+    }
+
+    // Sorted, merged, and without code point 0 (which labels epsilon edges)
+    CodePointRanges normalizeRanges(CodePointRanges ranges) {
+        std::sort(ranges.begin(), ranges.end());
+        CodePointRanges merged;
+        for (auto [lo, hi] : ranges) {
+            lo = std::max<uint32_t>(lo, 1);
+            if (lo > hi) continue;
+            if (!merged.empty() && lo <= merged.back().second + 1) merged.back().second = std::max(merged.back().second, hi);
+            else merged.push_back({ lo, hi });
+        }
+        return merged;
+    }
+
+    CodePointRanges complementRanges(const CodePointRanges& ranges) {
+        CodePointRanges result;
+        uint32_t next = 1;
+        for (const auto& [lo, hi] : normalizeRanges(ranges)) {
+            if (lo > next) result.push_back({ next, lo - 1 });
+            next = hi + 1;
+        }
+        if (next <= Utf8::MAX_CODE_POINT) result.push_back({ next, Utf8::MAX_CODE_POINT });
+        return result;
+    }
+
+    // A bracket expression is read as code points if it holds a \\u escape or non-ASCII bytes
+    bool isUnicodeClass(const std::string& regex, size_t open, size_t close) {
+        for (size_t i = open + 1; i < close; i++) {
+            if ((unsigned char)regex[i] >= 0x80) return true;
+            if (regex[i] == '\\' && i + 1 < close) {
+                if (regex[i + 1] == 'u') return true;
+                i++;
+            }
+        }
+        return false;
+    }
+
+    // Code points matched by the bracket expression regex[open..close]; same
+    // rules as parseClass, except that \\xHH names U+00HH and [^...] complements
+    // over all of Unicode
+    CodePointRanges parseUnicodeClass(const std::string& regex, size_t open, size_t close) {
+        CodePointRanges set;
+        size_t i = open + 1;
+        bool negate = (regex[i] == '^');
+        if (negate) i++;
+
+        // One member: returns its code point, or -1 after adding a class escape to set
+        auto member = [&](size_t& pos) -> int64_t {
+            uint32_t value; size_t next; bool isByte;
+            if (numericEscape(regex, pos, close, value, next, isByte)) {
+                pos = next;
+                return value;
+            }
+            if (regex[pos] == '\\' && pos + 1 < close) {
+                pos++;
+                char e = regex[pos];
+                std::bitset<256> bytes;
+                if (escapeClass((char)tolower((unsigned char)e), bytes)) {
+                    CodePointRanges cls;
+                    for (int b = 1; b < 256; b++) if (bytes.test(b)) cls.push_back({ (uint32_t)b, (uint32_t)b });
+                    if (isupper((unsigned char)e)) cls = complementRanges(cls);
+                    set.insert(set.end(), cls.begin(), cls.end());
+                    pos++;
+                    return -1;
+                }
+                return (unsigned char)escapeLiteral(regex[pos++]);
+            }
+            size_t n = Utf8::sequenceLength(regex.data() + pos, close - pos);
+            if (n > 1) {
+                uint32_t cp = Utf8::decode(regex.data() + pos, n);
+                pos += n;
+                return cp;
+            }
+            return (unsigned char)regex[pos++]; // ASCII, or a stray byte read as U+0080..U+00FF
+        };
+
+        while (i < close) {
+            int64_t lo = member(i);
+            if (lo < 0) continue;
+
+            if (i + 1 < close && regex[i] == '-') {
+                i++;
+                int64_t hi = member(i);
+                if (hi >= 0) {
+                    if (hi < lo) std::swap(lo, hi);
+                    set.push_back({ (uint32_t)lo, (uint32_t)hi });
+                    continue;
+                }
+                set.push_back({ '-', '-' });
+            }
+            set.push_back({ (uint32_t)lo, (uint32_t)lo });
+        }
+
+        return negate ? complementRanges(set) : normalizeRanges(set);
+    }
+
+    // Byte-level atom matching the UTF-8 encoding of any code point in ranges:
+    // one class for the ASCII part, one chain of byte classes per multi-byte sequence
+    std::string unicodeAtom(const CodePointRanges& ranges) {
+        std::vector<std::string> alternatives;
+        std::string ascii;
+        std::vector<Utf8::Sequence> sequences;
+
+        for (const auto& [lo, hi] : normalizeRanges(ranges)) {
+            if (lo < 0x80) ascii += hexByte((unsigned char)lo) + "-" + hexByte((unsigned char)std::min<uint32_t>(hi, 0x7F));
+            if (hi >= 0x80) Utf8::rangeSequences(std::max<uint32_t>(lo, 0x80), hi, sequences);
+        }
+
+        if (!ascii.empty()) alternatives.push_back("[" + ascii + "]");
+        for (const auto& seq : sequences) {
+            std::string chain;
+            for (const auto& r : seq) {
+                chain += "[" + hexByte(r.lo) + (r.lo == r.hi ? "" : "-" + hexByte(r.hi)) + "]";
+            }
+            alternatives.push_back(chain);
+        }
+
+        if (alternatives.empty()) return "[^\\x01-\\xFF]"; // Matches nothing
+        std::string atom = "(";
+        for (size_t k = 0; k < alternatives.size(); k++) {
+            if (k) atom += "|";
+            atom += alternatives[k];
+        }
+        return atom + ")";
+    }
+
+    // Rewrites the Unicode parts of regex into byte-level atoms (see above)
+    std::string expandUnicode(const std::string& regex) {
+        std::string res;
+        for (size_t i = 0; i < regex.length(); i++) {
+            char c = regex[i];
+
+            if (c == '\\') {
+                uint32_t value; size_t next; bool isByte;
+                if (numericEscape(regex, i, regex.length(), value, next, isByte)) {
+                    res += isByte ? "[" + hexByte((unsigned char)value) + "]" : unicodeAtom({ { value, value } });
+                    i = next - 1;
+                    continue;
+                }
+                res += c;
+                if (i + 1 < regex.length()) res += regex[++i];
+                continue;
+            }
+
+            if (c == '[') {
+                size_t close = classEnd(regex, i);
+                if (close != std::string::npos) {
+                    if (isUnicodeClass(regex, i, close)) res += unicodeAtom(parseUnicodeClass(regex, i, close));
+                    else res += regex.substr(i, close - i + 1);
+                    i = close;
+                    continue;
+                }
+            }
+
+            // A multi-byte character is one atom, so a following * applies to all of it
+            size_t n = Utf8::sequenceLength(regex.data() + i, regex.length() - i);
+            if (n > 1) {
+                uint32_t cp = Utf8::decode(regex.data() + i, n);
+                res += unicodeAtom({ { cp, cp } });
+                i += n - 1;
+                continue;
+            }
+            res += c;
+        }
+        return res;
+    }
+
+    // Repetition {m}, {m,} or {m,n} opening at regex[open]. On success close is the
+    // index of '}' and max is -1 for an open upper bound. Anything else is not a
+    // repetition (the '{' is then a literal).
+    bool parseRepeat(const std::string& regex, size_t open, size_t& close, int& min, int& max) {
+        auto number = [&](size_t& i, int& value) {
+            size_t start = i;
+            value = 0;
+            while (i < regex.length() && isdigit((unsigned char)regex[i])) {
+                value = std::min(value * 10 + (regex[i] - '0'), 1000000); // Saturate; rejected later
+                i++;
+            }
+            return i > start;
+        };
+
+        size_t i = open + 1;
+        if (!number(i, min)) return false;
+        max = min;
+        if (i < regex.length() && regex[i] == ',') {
+            i++;
+            if (!number(i, max)) max = -1;
+        }
+        if (i >= regex.length() || regex[i] != '}') return false;
+        close = i;
+        return true;
+    }
+
+    bool isRepeatAt(const std::string& regex, size_t pos) {
+        size_t close; int min, max;
+        return pos < regex.length() && regex[pos] == '{' && parseRepeat(regex, pos, close, min, max);
+    }
+
+    std::string RegexParser::preprocessRegex(const std::string& input) {
+        const std::string regex = expandUnicode(input);
         std::string res = "";
+
+        // Implicit concatenation after an atom: if the next char starts another atom, add dot
+        auto concatAfterAtom = [&](int i) {
+            if (i + 1 < (int)regex.length()) {
+                char next = regex[i+1];
+                bool nextIsOp = (next == '*' || next == '+' || next == '|' || next == ')' || isRepeatAt(regex, i+1));
+                if (!nextIsOp) res += '.';
+            }
+        };
+
         for (int i = 0; i < (int)regex.length(); i++) {
             char c1 = regex[i];
             
@@ -29,17 +398,41 @@ namespace Automata {
                 res += c1;
                 i++;
                 if (i < (int)regex.length()) res += regex[i];
-                
-                // Implicit concatenation after escaped char?
-                // If next is literal or (, add dot
-                if (i + 1 < (int)regex.length()) {
-                    char next = regex[i+1];
-                    // If next is not an operator (OR it is open paren), insert .
-                    bool nextIsOp = (next == '*' || next == '+' || next == '|' || next == ')' || next == '.');
-                    if (!nextIsOp || next == '(') {
-                        res += '.';
-                    }
+                concatAfterAtom(i);
+                continue;
+            }
+
+            // Repetition is copied as one postfix operator; any other '{' is a literal
+            if (c1 == '{') {
+                size_t close; int min, max;
+                if (parseRepeat(regex, i, close, min, max)) {
+                    res += regex.substr(i, close - i + 1);
+                    i = (int)close;
+                } else {
+                    res += "\\{";
+                }
+                concatAfterAtom(i);
+                continue;
+            }
+
+            // Bracket expression [...] is copied as one atom
+            if (c1 == '[') {
+                size_t close = classEnd(regex, i);
+                if (close == std::string::npos) {
+                    res += "\\["; // Unterminated: a literal '['
+                } else {
+                    res += regex.substr(i, close - i + 1);
+                    i = (int)close;
                 }
+                concatAfterAtom(i);
+                continue;
+            }
+
+            // '.' is the concatenation operator from here on, so the wildcard
+            // becomes "any byte but newline"
+            if (c1 == '.') {
+                res += "[^\\n]";
+                concatAfterAtom(i);
                 continue;
             }
 
@@ -52,11 +445,12 @@ namespace Automata {
                 bool c1IsPlus = (c1 == '+');
                 bool c1IsClose = (c1 == ')');
                 
-                bool c2IsLiteral = !isSpecial(c2);
+                bool c2IsLiteral = !isSpecial(c2) && !isRepeatAt(regex, i+1);
                 bool c2IsOpen = (c2 == '(');
                 bool c2IsEscape = (c2 == '\\');
+                bool c2IsWildcard = (c2 == '.');
 
-                if ((c1IsLiteral || c1IsStar || c1IsPlus || c1IsClose) && (c2IsLiteral || c2IsOpen || c2IsEscape)) {
+                if ((c1IsLiteral || c1IsStar || c1IsPlus || c1IsClose) && (c2IsLiteral || c2IsOpen || c2IsEscape || c2IsWildcard)) {
                     res += '.';
                 }
             } else {
@@ -79,6 +473,24 @@ namespace Automata {
                 i++;
                 if (i < (int)processed.length()) postfix += processed[i];
             }
+            else if (c == '{') {
+                // Repetition (literal braces are escaped after preprocessing).
+                // Binds like '*': pending '*' / '+' apply first.
+                size_t close; int min, max;
+                parseRepeat(processed, i, close, min, max);
+                while (!opStack.empty() && priority(opStack.top()) >= priority('*')) {
+                    postfix += opStack.top();
+                    opStack.pop();
+                }
+                postfix += processed.substr(i, close - i + 1);
+                i = (int)close;
+            }
+            else if (c == '[') {
+                // Bracket atom (always terminated after preprocessing)
+                size_t close = classEnd(processed, i);
+                postfix += processed.substr(i, close - i + 1);
+                i = (int)close;
+            }
             else if (isalnum(c) || !isSpecial(c)) {
                  postfix += c;
             }
@@ -124,16 +536,271 @@ namespace Automata {
         return offset;
     }
 
-    NFA RegexParser::toNFA(const std::string& postfix) {
+    // Two-state NFA accepting any single byte of set
+    NFA classNFA(const std::bitset<256>& set) {
+        NFA n;
+        int s1 = n.addState(false);
+        int s2 = n.addState(true);
+        for (int b = 1; b < 256; b++) {
+            if (!set.test(b)) continue;
+            int last = b;
+            while (last + 1 < 256 && set.test(last + 1)) last++;
+            n.addRangeTransition(s1, s2, (unsigned char)b, (unsigned char)last);
+            b = last;
+        }
+        n.startStateId = s1;
+        n.finalStateId = s2;
+        return n;
+    }
+
+    // A{min,max} (max == -1: unbounded) as a chain of copies of A. The optional
+    // copies after the first min can each skip straight to the end, which is
+    // the nested form (A(A(A)?)?)? and keeps the NFA linear in max.
+    // Throws if A{min,max} is malformed or would expand past the size guards
+    void checkRepeat(int min, int max, size_t statesPerCopy) {
+        if (max != -1 && max < min) {
+            throw std::invalid_argument("Regex repetition {" + std::to_string(min) + "," + std::to_string(max) + "}: max < min");
+        }
+        if (min > RegexParser::MAX_REPEAT || max > RegexParser::MAX_REPEAT) {
+            throw std::length_error("Regex repetition count above " + std::to_string(RegexParser::MAX_REPEAT));
+        }
+        size_t copies = (size_t)(max == -1 ? min + 1 : max);
+        if (statesPerCopy * copies > (size_t)RegexParser::MAX_NFA_STATES) {
+            throw std::length_error("Regex repetition would need more than " + std::to_string(RegexParser::MAX_NFA_STATES) + " NFA states");
+        }
+    }
+
+    NFA repeatNFA(const NFA& A, int min, int max) {
+        checkRepeat(min, max, A.states.size());
+
+        NFA res;
+        res.startStateId = res.finalStateId = res.addState(false);
+
+        // Appends a copy of A after the current final state; returns the copy's start
+        auto appendCopy = [&]() {
+            int offset = mergeNFA(res, A);
+            res.addTransition(res.finalStateId, A.startStateId + offset, '\0');
+            res.finalStateId = A.finalStateId + offset;
+            return A.startStateId + offset;
+        };
+
+        // 1. Mandatory copies
+        for (int k = 0; k < min; k++) appendCopy();
+
+        if (max == -1) {
+            // 2a. {m,}: one more copy that loops back on itself, or is skipped
+            int before = res.finalStateId;
+            int loopStart = appendCopy();
+            int end = res.addState(false);
+            res.addTransition(res.finalStateId, loopStart, '\0');
+            res.addTransition(res.finalStateId, end, '\0');
+            res.addTransition(before, end, '\0');
+            res.finalStateId = end;
+        } else {
+            // 2b. {m,n}: n - m optional copies
+            std::vector<int> skipFrom;
+            for (int k = min; k < max; k++) {
+                skipFrom.push_back(res.finalStateId);
+                appendCopy();
+            }
+            for (int from : skipFrom) res.addTransition(from, res.finalStateId, '\0');
+        }
+
+        for (auto& st : res.states) st.isFinal = false;
+        res.states[res.finalStateId].isFinal = true;
+        return res;
+    }
+
+    // Glushkov (position automaton) construction. Every symbol occurrence in the
+    // regex is a position; one pass over the postfix computes, per subexpression,
+    // whether it is nullable and its first / last positions, and records the
+    // follow relation. The NFA has the start state plus one state per position,
+    // entered on that position's bytes, and no epsilon edges.
+    class GlushkovBuilder {
+    public:
+        explicit GlushkovBuilder(const std::string& postfix) : postfix(postfix) {}
+
+        NFA build() {
+            Fragment root = evaluate(0, postfix.length());
+
+            for (auto& f : follow) {
+                std::sort(f.begin(), f.end());
+                f.erase(std::unique(f.begin(), f.end()), f.end());
+            }
+
+            NFA nfa;
+            nfa.startStateId = nfa.addState(root.nullable);
+            for (size_t p = 0; p < positions.size(); p++) nfa.addState(false);
+            for (int p : root.last) nfa.states[p].isFinal = true;
+            nfa.finalStateId = -1; // Accepting states are the isFinal ones
+
+            for (int p : root.first) addEdges(nfa, nfa.startStateId, p);
+            for (size_t p = 1; p < follow.size(); p++) {
+                for (int q : follow[p]) addEdges(nfa, (int)p, q);
+            }
+
+            nfa.optimize(); // Drops positions made unreachable by {0}
+            return nfa;
+        }
+
+    private:
+        struct Fragment {
+            size_t begin;          // Postfix index where the subexpression starts
+            bool nullable;
+            std::vector<int> first;
+            std::vector<int> last;
+        };
+
+        const std::string& postfix;
+        std::vector<std::bitset<256>> positions = { {} }; // Bytes per position; 0 is the start state
+        std::vector<std::vector<int>> follow = { {} };
+
+        // Edges into position q, one per byte range
+        void addEdges(NFA& nfa, int from, int q) {
+            const std::bitset<256>& set = positions[q];
+            for (int b = 1; b < 256; b++) {
+                if (!set.test(b)) continue;
+                int last = b;
+                while (last + 1 < 256 && set.test(last + 1)) last++;
+                nfa.addRangeTransition(from, q, (unsigned char)b, (unsigned char)last);
+                b = last;
+            }
+        }
+
+        Fragment symbol(size_t begin, const std::bitset<256>& set) {
+            int p = (int)positions.size();
+            if (p > RegexParser::MAX_NFA_STATES) {
+                throw std::length_error("Regex would need more than " + std::to_string(RegexParser::MAX_NFA_STATES) + " NFA states");
+            }
+            positions.push_back(set);
+            follow.emplace_back();
+            return { begin, false, { p }, { p } };
+        }
+
+        static Fragment empty(size_t begin) { return { begin, true, {}, {} }; }
+
+        void loop(const Fragment& a) {
+            for (int p : a.last) follow[p].insert(follow[p].end(), a.first.begin(), a.first.end());
+        }
+
+        Fragment concat(const Fragment& a, const Fragment& b) {
+            for (int p : a.last) follow[p].insert(follow[p].end(), b.first.begin(), b.first.end());
+            Fragment r{ a.begin, a.nullable && b.nullable, a.first, b.last };
+            if (a.nullable) r.first.insert(r.first.end(), b.first.begin(), b.first.end());
+            if (b.nullable) r.last.insert(r.last.end(), a.last.begin(), a.last.end());
+            return r;
+        }
+
+        static Fragment alternate(const Fragment& a, const Fragment& b) {
+            Fragment r{ a.begin, a.nullable || b.nullable, a.first, a.last };
+            r.first.insert(r.first.end(), b.first.begin(), b.first.end());
+            r.last.insert(r.last.end(), b.last.begin(), b.last.end());
+            return r;
+        }
+
+        // A{min,max}: copies of A are fresh positions, made by re-reading A's postfix
+        Fragment repeat(const Fragment& a, size_t end, int min, int max) {
+            checkRepeat(min, max, countPositions(a.begin, end));
+            if (max == 0) return empty(a.begin);
+
+            int copies = (max == -1) ? std::max(min, 1) : max;
+            Fragment r = a;
+            if (min == 0) r.nullable = true;
+            if (max == -1 && copies == 1) loop(r);
+            for (int k = 1; k < copies; k++) {
+                Fragment c = evaluate(a.begin, end);
+                if (k >= min) c.nullable = true;
+                if (max == -1 && k == copies - 1) loop(c);
+                r = concat(r, c);
+            }
+            r.begin = a.begin;
+            return r;
+        }
+
+        // Symbols in postfix[begin, end), i.e. positions per copy of a subexpression
+        size_t countPositions(size_t begin, size_t end) const {
+            size_t count = 0;
+            for (size_t i = begin; i < end; i++) {
+                char c = postfix[i];
+                if (c == '\\') { i++; count++; }
+                else if (c == '[' && classEnd(postfix, i) != std::string::npos) { i = classEnd(postfix, i); count++; }
+                else if (c == '{' && isRepeatAt(postfix, i)) { size_t close; int lo, hi; parseRepeat(postfix, i, close, lo, hi); i = close; }
+                else if (!isSpecial(c)) count++;
+            }
+            return std::max<size_t>(count, 1);
+        }
+
+        Fragment evaluate(size_t from, size_t to) {
+            std::vector<Fragment> stack;
+
+            for (size_t i = from; i < to; i++) {
+                char c = postfix[i];
+
+                if (c == '\\') {
+                    size_t begin = i++;
+                    char lit = (i < to) ? postfix[i] : '\\';
+                    std::bitset<256> set;
+                    if (!escapeClass(lit, set)) set.set((unsigned char)escapeLiteral(lit));
+                    set.reset(0);
+                    stack.push_back(symbol(begin, set));
+                }
+                else if (c == '{' && isRepeatAt(postfix, i)) {
+                    size_t close; int min, max;
+                    parseRepeat(postfix, i, close, min, max);
+                    if (!stack.empty()) {
+                        Fragment a = stack.back(); stack.pop_back();
+                        stack.push_back(repeat(a, i, min, max));
+                    }
+                    i = close;
+                }
+                else if (c == '[' && classEnd(postfix, i) != std::string::npos) {
+                    size_t close = classEnd(postfix, i);
+                    stack.push_back(symbol(i, parseClass(postfix, i, close)));
+                    i = close;
+                }
+                else if (!isSpecial(c)) {
+                    std::bitset<256> set;
+                    set.set((unsigned char)c);
+                    set.reset(0);
+                    stack.push_back(symbol(i, set));
+                }
+                else if (c == '.' || c == '|') {
+                    if (stack.size() < 2) continue;
+                    Fragment b = stack.back(); stack.pop_back();
+                    Fragment a = stack.back(); stack.pop_back();
+                    stack.push_back(c == '.' ? concat(a, b) : alternate(a, b));
+                }
+                else if (c == '*' || c == '+') {
+                    if (stack.empty()) continue;
+                    loop(stack.back());
+                    if (c == '*') stack.back().nullable = true;
+                }
+            }
+
+            if (stack.empty()) return empty(from);
+            return stack.back();
+        }
+    };
+
+    NFA RegexParser::toNFA(const std::string& postfix, NFAConstruction method) {
+        if (method == NFAConstruction::Glushkov) return GlushkovBuilder(postfix).build();
+
         std::stack<NFA> stack;
 
         for (int i = 0; i < (int)postfix.length(); i++) {
             char c = postfix[i];
 
             if (c == '\\') {
-                // Literal
+                // Literal, or a class escape such as \d
                 i++;
                 char lit = (i < (int)postfix.length()) ? postfix[i] : '\\';
+
+                std::bitset<256> set;
+                if (escapeClass(lit, set)) {
+                    stack.push(classNFA(set));
+                    continue;
+                }
+                lit = escapeLiteral(lit);
                 
                 NFA n;
                 int s1 = n.addState(false);
@@ -143,6 +810,21 @@ namespace Automata {
                 n.finalStateId = s2;
                 stack.push(n);
             }
+            else if (c == '{' && isRepeatAt(postfix, i)) {
+                // Bounded repetition A{m,n}
+                size_t close; int min, max;
+                parseRepeat(postfix, i, close, min, max);
+                i = (int)close;
+                if (stack.empty()) continue;
+                NFA A = stack.top(); stack.pop();
+                stack.push(repeatNFA(A, min, max));
+            }
+            else if (c == '[' && classEnd(postfix, i) != std::string::npos) {
+                // Character class: one range-labelled edge per run of member bytes
+                size_t close = classEnd(postfix, i);
+                stack.push(classNFA(parseClass(postfix, i, close)));
+                i = (int)close;
+            }
             else if (!isSpecial(c)) { 
                 // Literal
                 NFA n;
@@ -277,116 +959,377 @@ namespace Automata {
         return result;
     }
 
-    std::set<int> epsilonClosure(const NFA& nfa, const std::set<int>& states) {
-        std::set<int> closure = states;
-        std::stack<int> stack;
-        for(int s : states) stack.push(s);
-        
-        while(!stack.empty()) {
-            int u = stack.top(); stack.pop();
-            if (u >= 0 && u < (int)nfa.states.size()) {
-                for(const auto& t : nfa.states[u].transitions) {
-                    if(t.input == '\0') {
-                        if(closure.find(t.targetStateId) == closure.end()) {
-                            closure.insert(t.targetStateId);
-                            stack.push(t.targetStateId);
-                        }
-                    }
-                }
+    NFA RegexParser::combineNFAs(const std::vector<NFA>& rules) {
+        NFA combined;
+        int start = combined.addState(false);
+        combined.startStateId = start;
+        combined.finalStateId = -1;
+
+        for (int r = 0; r < (int)rules.size(); r++) {
+            const NFA& rule = rules[r];
+            if (rule.states.empty()) continue;
+
+            int offset = mergeNFA(combined, rule);
+            combined.addTransition(start, rule.startStateId + offset, '\0');
+            std::vector<int> accepts = rule.acceptingRules();
+            for (int s = 0; s < (int)accepts.size(); s++) {
+                if (accepts[s] != -1) combined.acceptRuleMap[s + offset] = r;
             }
         }
-        return closure;
+        return combined;
     }
 
-    std::set<int> move(const NFA& nfa, const std::set<int>& states, char c) {
-        std::set<int> result;
-        for(int s : states) {
-            if (s >= 0 && s < (int)nfa.states.size()) {
-                for(const auto& t : nfa.states[s].transitions) {
-                    if(t.input == c) {
-                        result.insert(t.targetStateId);
-                    }
-                }
-            }
+    // Rule index accepted by an NFA subset, or -1 if it contains no accept state.
+    // The lowest index wins, i.e. the rule declared first.
+    int acceptingRule(const std::vector<std::pair<int, int>>& accepts, const StateSet& subset) {
+        int best = -1;
+        for (const auto& [state, rule] : accepts) {
+            if ((best == -1 || rule < best) && subset.contains(state)) best = rule;
         }
-        return result;
+        return best;
     }
 
     DFA RegexParser::toDFA(const NFA& nfa, TokenType type) {
+        return toDFA(nfa, std::vector<TokenType>{ type });
+    }
+
+    DFA RegexParser::toDFA(const NFA& nfa, const std::vector<TokenType>& ruleTypes) {
         DFA dfa;
         if (nfa.states.empty()) return dfa;
 
-        // 1. Initial State = E-Closure(NFA Start)
-        std::set<int> startSet; 
-        startSet.insert(nfa.startStateId);
-        startSet = epsilonClosure(nfa, startSet);
-        
-        int startId = dfa.states.size(); // 0
-        State startState;
-        startState.id = startId;
-        startState.nfaStateIds = startSet; // Track subset
-        
-        if(startSet.count(nfa.finalStateId)) {
-            startState.isFinal = true;
-            dfa.stateTokenMap[startId] = type;
-        } else {
-            startState.isFinal = false;
+        const int nfaStates = (int)nfa.states.size();
+        EpsilonClosures closures(nfa);
+        std::vector<std::pair<int, int>> accepts; // (NFA state, rule)
+        std::vector<int> ruleOfState = nfa.acceptingRules();
+        for (int s = 0; s < nfaStates; s++) {
+            if (ruleOfState[s] != -1) accepts.push_back({ s, ruleOfState[s] });
         }
-        dfa.states.push_back(startState);
-        dfa.startStateId = startId;
-        
+        std::unordered_map<StateSet, int, StateSet::Hash> subsetIds;
+        std::vector<StateSet> subsets; // Indexed by DFA state id
+
+        // Adds a DFA state for subset unless it exists; returns its id
+        auto internSubset = [&](const StateSet& subset, std::queue<int>& q) {
+            auto it = subsetIds.find(subset);
+            if (it != subsetIds.end()) return it->second;
+
+            if ((int)dfa.states.size() >= MAX_DFA_STATES) {
+                throw std::length_error("Regex needs more than " + std::to_string(MAX_DFA_STATES) + " DFA states");
+            }
+
+            State newState;
+            newState.id = (int)dfa.states.size();
+            subset.forEach([&](int s) { newState.nfaStateIds.insert(newState.nfaStateIds.end(), s); }); // Track subset
+            int rule = acceptingRule(accepts, subset);
+            newState.isFinal = (rule != -1);
+            if (newState.isFinal) {
+                dfa.stateTokenMap[newState.id] = (rule < (int)ruleTypes.size()) ? ruleTypes[rule] : TOKEN_INVALID;
+            }
+            dfa.states.push_back(newState);
+
+            subsetIds.emplace(subset, newState.id);
+            subsets.push_back(subset);
+            q.push(newState.id);
+            return newState.id;
+        };
+
+        // 1. Initial State = E-Closure(NFA Start)
         std::queue<int> q;
-        q.push(startId);
-        
-        // Find Alphabet
-        std::set<char> alphabet;
-        for(const auto& s : nfa.states) 
-            for(const auto& t : s.transitions) 
-                if(t.input != '\0') alphabet.insert(t.input);
-                
-        // Subset Construction
+        StateSet startSet(nfaStates);
+        closures.addTo(nfa.startStateId, startSet);
+        dfa.startStateId = internSubset(startSet, q);
+
+        // 2. Input alphabet: the elementary byte intervals cut out by the NFA's
+        // transitions. Every range transition covers a contiguous run of them.
+        bool cut[257] = {};
+        for (const auto& st : nfa.states) {
+            for (const auto& t : st.transitions) {
+                if (t.isEpsilon()) continue;
+                cut[t.firstByte()] = true;
+                cut[t.lastByte() + 1] = true;
+            }
+        }
+        std::vector<int> symbolFirst;
+        int symbolOf[256];
+        for (int b = 0; b < 256; b++) {
+            if (cut[b]) symbolFirst.push_back(b);
+            symbolOf[b] = (int)symbolFirst.size() - 1;
+        }
+        symbolFirst.push_back(256);
+        const int symbolCount = (int)symbolFirst.size() - 1;
+
+        // 3. Subset Construction. One sweep over a subset's NFA states ORs the
+        // precomputed closure of every target into each covered symbol's bucket.
+        std::vector<StateSet> buckets(symbolCount, StateSet(nfaStates));
+        std::vector<char> isTouched(symbolCount, 0);
+        std::vector<int> touched;
+
         while(!q.empty()) {
             int currentDfaId = q.front(); q.pop();
-            std::set<int> currentSet = dfa.states[currentDfaId].nfaStateIds;
-            
-            for(char c : alphabet) {
-                // move(T, a) -> closure
-                std::set<int> nextSet = epsilonClosure(nfa, move(nfa, currentSet, c));
-                
-                if(nextSet.empty()) continue; // No transition
-                
-                // Check if existing
-                int targetId = -1;
-                for(const auto& s : dfa.states) {
-                    if(s.nfaStateIds == nextSet) {
-                        targetId = s.id;
-                        break;
+
+            touched.clear();
+            subsets[currentDfaId].forEach([&](int s) {
+                for (const auto& t : nfa.states[s].transitions) {
+                    if (t.isEpsilon()) continue;
+                    for (int c = symbolOf[t.firstByte()]; c <= symbolOf[t.lastByte()]; c++) {
+                        if (!isTouched[c]) { isTouched[c] = 1; touched.push_back(c); }
+                        closures.addTo(t.targetStateId, buckets[c]);
                     }
                 }
-                
-                if(targetId == -1) {
-                    // New DFA state
-                    State newState;
-                    newState.id = (int)dfa.states.size();
-                    newState.nfaStateIds = nextSet;
-                    newState.isFinal = (nextSet.count(nfa.finalStateId) > 0);
-                    if(newState.isFinal) dfa.stateTokenMap[newState.id] = type;
-                    
-                    targetId = newState.id;
-                    dfa.states.push_back(newState);
-                    q.push(targetId);
+            });
+            std::sort(touched.begin(), touched.end());
+
+            // Neighbouring symbols that lead to the same subset share one range transition
+            int runFirst = -1, runLast = -1, runTarget = -1;
+            for (int c : touched) {
+                int targetId = internSubset(buckets[c], q);
+                buckets[c].clear();
+                isTouched[c] = 0;
+
+                if (runTarget == targetId && runLast == symbolFirst[c] - 1) {
+                    runLast = symbolFirst[c + 1] - 1;
+                    continue;
                 }
-                
-                dfa.addTransition(currentDfaId, targetId, c);
+                if (runTarget != -1) dfa.addRangeTransition(currentDfaId, runTarget, (unsigned char)runFirst, (unsigned char)runLast);
+                runFirst = symbolFirst[c];
+                runLast = symbolFirst[c + 1] - 1;
+                runTarget = targetId;
             }
+            if (runTarget != -1) dfa.addRangeTransition(currentDfaId, runTarget, (unsigned char)runFirst, (unsigned char)runLast);
         }
         
         dfa.optimize(); // Ensure clean result (remove unreachable etc)
         return dfa;
     }
     
-    DFA RegexParser::createDFA(const std::string& regex, TokenType type) {
-         return toDFA(toNFA(toPostfix(regex)), type);
+    // Required literals (RegexParser::extractLiterals). Same postfix walk as
+    // GlushkovBuilder, but each subexpression carries string sets instead of
+    // positions: its whole language if that is small and finite, and sets that
+    // every match starts with / ends with / contains. {""} means "unknown".
+    class LiteralAnalyzer {
+    public:
+        using Strings = std::vector<std::string>;
+
+        struct Facts {
+            bool nullable;
+            bool finite;   // exact holds the whole language
+            Strings exact;
+            Strings prefix;
+            Strings suffix;
+            Strings factor;
+        };
+
+        explicit LiteralAnalyzer(const std::string& postfix) : postfix(postfix) {}
+
+        Facts evaluate() {
+            std::vector<Facts> stack;
+
+            for (size_t i = 0; i < postfix.length(); i++) {
+                char c = postfix[i];
+
+                if (c == '\\') {
+                    i++;
+                    char lit = (i < postfix.length()) ? postfix[i] : '\\';
+                    std::bitset<256> set;
+                    if (!escapeClass(lit, set)) set.set((unsigned char)escapeLiteral(lit));
+                    set.reset(0);
+                    stack.push_back(symbol(set));
+                }
+                else if (c == '{' && isRepeatAt(postfix, i)) {
+                    size_t close; int min, max;
+                    parseRepeat(postfix, i, close, min, max);
+                    if (!stack.empty()) stack.back() = repeat(stack.back(), min, max);
+                    i = close;
+                }
+                else if (c == '[' && classEnd(postfix, i) != std::string::npos) {
+                    size_t close = classEnd(postfix, i);
+                    stack.push_back(symbol(parseClass(postfix, i, close)));
+                    i = close;
+                }
+                else if (!isSpecial(c)) {
+                    std::bitset<256> set;
+                    set.set((unsigned char)c);
+                    set.reset(0);
+                    stack.push_back(symbol(set));
+                }
+                else if (c == '.' || c == '|') {
+                    if (stack.size() < 2) continue;
+                    Facts b = stack.back(); stack.pop_back();
+                    Facts a = stack.back(); stack.pop_back();
+                    stack.push_back(c == '.' ? concat(a, b) : alternate(a, b));
+                }
+                else if (c == '*' || c == '+') {
+                    if (stack.empty()) continue;
+                    stack.back() = (c == '*') ? unknown(true) : plus(stack.back());
+                }
+            }
+
+            if (stack.empty()) return empty();
+            return stack.back();
+        }
+
+        static bool isUnknown(const Strings& set) { return set.empty() || set[0].empty(); }
+
+        // Longer shortest string first, then fewer strings
+        static const Strings& better(const Strings& a, const Strings& b) {
+            if (isUnknown(b)) return a;
+            if (isUnknown(a)) return b;
+            size_t shortestA = a[0].length(), shortestB = b[0].length();
+            for (const auto& s : a) shortestA = std::min(shortestA, s.length());
+            for (const auto& s : b) shortestB = std::min(shortestB, s.length());
+            if (shortestA != shortestB) return shortestA > shortestB ? a : b;
+            return a.size() <= b.size() ? a : b;
+        }
+
+    private:
+        const std::string& postfix;
+
+        static Strings unique(Strings set) {
+            std::sort(set.begin(), set.end());
+            set.erase(std::unique(set.begin(), set.end()), set.end());
+            return set;
+        }
+
+        // As a prefix / suffix / factor set, one holding "" says nothing, so it collapses to {""}
+        static Strings normalize(Strings set) {
+            set = unique(set);
+            if (set.empty() || set[0].empty()) return { "" };
+            return set;
+        }
+
+        // Cuts a set down to the size limits. Shortening keeps the front of
+        // each string for prefixes / factors and the back for suffixes.
+        static Strings shrink(Strings set, bool keepBack) {
+            auto cut = [&](size_t length) {
+                for (auto& s : set) {
+                    if (s.length() > length) s = keepBack ? s.substr(s.length() - length) : s.substr(0, length);
+                }
+                set = normalize(set);
+            };
+            cut(RegexParser::MAX_LITERAL_LENGTH);
+            if (set.size() > (size_t)RegexParser::MAX_LITERALS) cut(1);
+            if (set.size() > (size_t)RegexParser::MAX_LITERALS) return { "" };
+            return set;
+        }
+
+        // Every a + b; false if the result would break the size limits
+        static bool cross(const Strings& a, const Strings& b, Strings& out) {
+            if (a.size() * b.size() > (size_t)RegexParser::MAX_LITERALS) return false;
+            out.clear();
+            for (const auto& x : a) {
+                for (const auto& y : b) {
+                    if (x.length() + y.length() > (size_t)RegexParser::MAX_LITERAL_LENGTH) return false;
+                    out.push_back(x + y);
+                }
+            }
+            out = unique(out);
+            return true;
+        }
+
+        static Strings join(const Strings& a, const Strings& b) {
+            Strings all = a;
+            all.insert(all.end(), b.begin(), b.end());
+            return unique(all);
+        }
+
+        static Facts unknown(bool nullable) { return { nullable, false, {}, { "" }, { "" }, { "" } }; }
+        static Facts empty() { return { true, true, { "" }, { "" }, { "" }, { "" } }; }
+
+        static Facts symbol(const std::bitset<256>& set) {
+            if (set.none() || set.count() > (size_t)RegexParser::MAX_LITERALS) return unknown(false);
+            Strings bytes;
+            for (int b = 1; b < 256; b++) {
+                if (set.test(b)) bytes.push_back(std::string(1, (char)b));
+            }
+            return { false, true, bytes, bytes, bytes, bytes };
+        }
+
+        static Facts concat(const Facts& a, const Facts& b) {
+            Facts r = unknown(a.nullable && b.nullable);
+            r.finite = a.finite && b.finite && cross(a.exact, b.exact, r.exact);
+            if (!r.finite) r.exact.clear();
+
+            // 1. Prefixes: a's whole language extended by b's prefixes, if both are known
+            if (!a.finite) r.prefix = a.prefix;
+            else if (!cross(a.exact, b.prefix, r.prefix)) r.prefix = shrink(a.exact, false);
+            r.prefix = normalize(r.prefix);
+
+            // 2. Suffixes, mirrored
+            if (!b.finite) r.suffix = b.suffix;
+            else if (!cross(a.suffix, b.exact, r.suffix)) r.suffix = shrink(b.exact, true);
+            r.suffix = normalize(r.suffix);
+
+            // 3. Factors: either side's, or one that spans the boundary
+            Strings across;
+            r.factor = better(a.factor, b.factor);
+            if (cross(a.suffix, b.prefix, across)) r.factor = better(r.factor, normalize(across));
+            if (r.finite) r.factor = better(r.factor, r.exact);
+            r.factor = better(r.factor, better(r.prefix, r.suffix));
+            return r;
+        }
+
+        static Facts alternate(const Facts& a, const Facts& b) {
+            Facts r = unknown(a.nullable || b.nullable);
+            if (a.finite && b.finite) {
+                r.exact = join(a.exact, b.exact);
+                r.finite = (r.exact.size() <= (size_t)RegexParser::MAX_LITERALS);
+                if (!r.finite) r.exact.clear();
+            }
+            r.prefix = shrink(join(a.prefix, b.prefix), false);
+            r.suffix = shrink(join(a.suffix, b.suffix), true);
+            r.factor = shrink(join(a.factor, b.factor), false);
+            return r;
+        }
+
+        // A+ starts, ends and contains what A does
+        static Facts plus(const Facts& a) {
+            Facts r = a;
+            r.finite = false;
+            r.exact.clear();
+            return r;
+        }
+
+        // A{min,max}: min mandatory copies, then an optional tail that says nothing
+        static Facts repeat(const Facts& a, int min, int max) {
+            if (max == 0) return empty();
+            if (min == 0) return unknown(true);
+
+            Facts r = a;
+            for (int k = 1; k < min; k++) {
+                // Past the length limit nothing more can be learnt from further copies
+                if (k >= RegexParser::MAX_LITERAL_LENGTH) {
+                    r = concat(r, unknown(a.nullable));
+                    break;
+                }
+                r = concat(r, a);
+            }
+            if (max != min) r = concat(r, unknown(true));
+            return r;
+        }
+    };
+
+    RegexLiterals RegexParser::extractLiterals(const std::string& regex) {
+        std::string postfix = toPostfix(regex);
+        LiteralAnalyzer::Facts root = LiteralAnalyzer(postfix).evaluate();
+
+        RegexLiterals literals;
+        literals.nullable = root.nullable;
+        if (root.nullable) return literals;
+
+        if (!LiteralAnalyzer::isUnknown(root.prefix)) literals.prefixes = root.prefix;
+        const auto& factors = LiteralAnalyzer::better(root.factor, root.prefix);
+        if (!LiteralAnalyzer::isUnknown(factors)) literals.factors = factors;
+        return literals;
+    }
+
+    std::shared_ptr<const DFA> RegexParser::createDFA(const std::string& regex, TokenType type, NFAConstruction method) {
+        uint32_t flags = (method == NFAConstruction::Glushkov) ? RegexCache::GLUSHKOV : 0;
+        RegexCache::Entry entry = RegexCache::global().getOrCompile({ regex, flags, type }, [&]() {
+            CompiledRegex compiled;
+            compiled.dfa = toDFA(toNFA(toPostfix(regex), method), type);
+            return compiled;
+        });
+        // Aliasing pointer: owns the entry, points at its DFA
+        return std::shared_ptr<const DFA>(entry, &entry->dfa);
     }
 
 }
@@ -1,21 +1,63 @@
 #pragma once
+#include <memory>
 #include <string>
 #include <vector>
 #include "FA.h"
 
 namespace Automata {
     
+    // How toNFA turns a postfix regex into an NFA
+    enum class NFAConstruction {
+        Thompson, // Epsilon-linked fragments, ~2 states per symbol and operator
+        Glushkov  // Position automaton: one state per symbol occurrence, no epsilons
+    };
+
+    // Literal strings every match of a regex must start with / contain, used to
+    // skip ahead with memchr / memmem-style scans before running the DFA
+    // (see RegexSearch). An empty list means nothing is known.
+    struct RegexLiterals {
+        std::vector<std::string> prefixes; // Every match starts with one of these
+        std::vector<std::string> factors;  // Every match contains one of these
+        bool nullable = false;             // Matches the empty string
+    };
+
     class RegexParser {
     public:
+        // Compile-size guards. Exceeding one throws std::length_error instead of
+        // quietly building a huge automaton (e.g. x{1000}{1000} or (a|b)*a(a|b){20}).
+        static constexpr int MAX_REPEAT = 1000;        // Largest m / n in {m,n}
+        static constexpr int MAX_NFA_STATES = 100000;  // After expanding repetitions
+        static constexpr int MAX_DFA_STATES = 50000;   // Subset construction budget
+
         // Main pipeline: Regex String -> Postfix -> NFA -> DFA
-        static DFA createDFA(const std::string& regex, TokenType type);
+        // Syntax: literals, \x escapes (\n \t \r), [a-z] / [^...] classes, \d \w \s
+        // (negated: \D \W \S), . for any byte but newline, * + | ( ) and the
+        // repetitions {m}, {m,} and {m,n}. \xHH is a raw byte; \uHHHH, \u{H...}
+        // and non-ASCII UTF-8 text are code points, and a class naming any of them
+        // ([\u{400}-\u{4FF}], [^é]) is a set of code points. These are compiled
+        // into their UTF-8 byte sequences, so the automata still run over bytes.
+        // Results are kept in RegexCache::global(), so repeating a call is a lookup.
+        // The DFA is shared with the cache entry and stays valid while held.
+        static std::shared_ptr<const DFA> createDFA(const std::string& regex, TokenType type, NFAConstruction method = NFAConstruction::Thompson);
 
         // Individual steps (public for visualization access)
         static std::string preprocessRegex(const std::string& regex); // Adds explicit concatenation '.'
         static std::string toPostfix(const std::string& infix);
-        static NFA toNFA(const std::string& postfix);
+        static NFA toNFA(const std::string& postfix, NFAConstruction method = NFAConstruction::Thompson);
         static DFA toDFA(const NFA& nfa, TokenType type);
-        
+
+        // Lexer pipeline: join one NFA per rule under a fresh start state and
+        // determinize once. Accepting DFA states carry the type of the
+        // earliest-declared rule they accept (ruleTypes[rule index]).
+        static NFA combineNFAs(const std::vector<NFA>& rules);
+        static DFA toDFA(const NFA& nfa, const std::vector<TokenType>& ruleTypes);
+
+        // Search prefilter: required literal prefixes and factors of regex.
+        // Lists are kept short (MAX_LITERALS strings of at most MAX_LITERAL_LENGTH bytes).
+        static constexpr int MAX_LITERALS = 8;
+        static constexpr int MAX_LITERAL_LENGTH = 64;
+        static RegexLiterals extractLiterals(const std::string& regex);
+
     private:
         static int priority(char op);
     };
@@ -0,0 +1,317 @@
+#include "RegexSearch.h"
+#include "StateSet.h"
+#include <bitset>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace Automata {
+
+    static constexpr size_t NONE = (size_t)-1;
+
+    // Byte set as ScanKernels ranges. Past MAX_RUN_RANGES the closest ranges are
+    // merged, which over-approximates the set; exact tells whether that happened.
+    static ScanKernels::ByteRanges toRanges(const std::bitset<256>& set, bool& exact) {
+        std::vector<std::pair<int, int>> runs;
+        for (int b = 0; b < 256; b++) {
+            if (!set.test(b)) continue;
+            int last = b;
+            while (last + 1 < 256 && set.test(last + 1)) last++;
+            runs.push_back({ b, last });
+            b = last;
+        }
+
+        exact = (runs.size() <= (size_t)ScanKernels::MAX_RUN_RANGES);
+        while (runs.size() > (size_t)ScanKernels::MAX_RUN_RANGES) {
+            size_t best = 0;
+            for (size_t i = 1; i + 1 < runs.size(); i++) {
+                if (runs[i + 1].first - runs[i].second < runs[best + 1].first - runs[best].second) best = i;
+            }
+            runs[best].second = runs[best + 1].second;
+            runs.erase(runs.begin() + best + 1);
+        }
+
+        ScanKernels::ByteRanges ranges;
+        for (const auto& [lo, hi] : runs) {
+            ranges.lo[ranges.count] = (unsigned char)lo;
+            ranges.hi[ranges.count] = (unsigned char)hi;
+            ranges.count++;
+        }
+        return ranges;
+    }
+
+    // The same language read backwards: edges flipped, a fresh start that can
+    // enter any accepting state, and the old start as the only accepting state
+    static NFA reverseNFA(const NFA& nfa) {
+        NFA rev;
+        for (size_t s = 0; s < nfa.states.size(); s++) rev.addState(false);
+        for (const auto& st : nfa.states) {
+            for (const auto& t : st.transitions) {
+                if (t.isEpsilon()) rev.addTransition(t.targetStateId, st.id, '\0');
+                else rev.addRangeTransition(t.targetStateId, st.id, t.firstByte(), t.lastByte());
+            }
+        }
+
+        std::vector<int> accepting = nfa.acceptingRules();
+        rev.startStateId = rev.addState(false);
+        for (size_t s = 0; s < accepting.size(); s++) {
+            if (accepting[s] != -1) rev.addTransition(rev.startStateId, (int)s, '\0');
+        }
+        rev.finalStateId = nfa.startStateId;
+        rev.states[rev.finalStateId].isFinal = true;
+        return rev;
+    }
+
+    // Unanchored leftmost-longest DFA (the forward automaton, see RegexSearch.h).
+    // A DFA state is a list of NFA-state groups, one per start position still
+    // alive, oldest first. A state reached from an older start is dropped from
+    // younger groups: both would continue the same way and the older one wins.
+    // Built straight into table form, since the unanchored loop also has to
+    // cover byte 0, which the State/Transition graph cannot label.
+    static CompiledDFA leftmostDFA(const NFA& nfa) {
+        const int n = (int)nfa.states.size();
+        EpsilonClosures closures(nfa);
+        std::vector<int> ruleOfState = nfa.acceptingRules();
+
+        // 1. Alphabet: elementary byte intervals, covering all 256 bytes
+        bool cut[257] = {};
+        cut[0] = true;
+        for (const auto& st : nfa.states) {
+            for (const auto& t : st.transitions) {
+                if (t.isEpsilon()) continue;
+                cut[t.firstByte()] = true;
+                cut[t.lastByte() + 1] = true;
+            }
+        }
+        unsigned char byteClass[256];
+        std::vector<unsigned char> symbolFirst;
+        for (int b = 0; b < 256; b++) {
+            if (cut[b]) symbolFirst.push_back((unsigned char)b);
+            byteClass[b] = (unsigned char)(symbolFirst.size() - 1);
+        }
+        const int classCount = (int)symbolFirst.size();
+
+        struct Groups {
+            std::vector<StateSet> sets;
+            bool matched; // Some group has accepted: no new starts from here on
+            bool operator==(const Groups& other) const { return matched == other.matched && sets == other.sets; }
+        };
+        struct GroupsHash {
+            size_t operator()(const Groups& g) const {
+                size_t h = g.matched ? 0x9e3779b9u : 0;
+                for (const auto& s : g.sets) h = h * 31 + StateSet::Hash()(s);
+                return h;
+            }
+        };
+
+        std::vector<Groups> states;
+        std::unordered_map<Groups, int32_t, GroupsHash> index;
+        std::vector<int32_t> table(classCount, CompiledDFA::DEAD_STATE); // Row 0: dead
+        std::vector<int32_t> acceptTokens(1, -1);
+
+        auto accepts = [&](const StateSet& set) {
+            bool found = false;
+            set.forEach([&](int s) { if (ruleOfState[s] != -1) found = true; });
+            return found;
+        };
+
+        // Row for key after cutting the groups younger than the oldest accepting one
+        auto intern = [&](Groups key) -> int32_t {
+            bool accepting = false;
+            for (size_t g = 0; g < key.sets.size(); g++) {
+                if (accepts(key.sets[g])) {
+                    key.sets.resize(g + 1);
+                    key.matched = accepting = true;
+                    break;
+                }
+            }
+            if (key.sets.empty()) return CompiledDFA::DEAD_STATE;
+
+            auto it = index.find(key);
+            if (it != index.end()) return it->second;
+            if ((int)states.size() >= RegexParser::MAX_DFA_STATES) {
+                throw std::length_error("Regex search DFA would need more than " + std::to_string(RegexParser::MAX_DFA_STATES) + " states");
+            }
+            int32_t row = (int32_t)states.size() + 1;
+            states.push_back(key);
+            index.emplace(std::move(key), row);
+            table.resize(table.size() + classCount, CompiledDFA::DEAD_STATE);
+            acceptTokens.push_back(accepting ? TOKEN_UNKNOWN : -1);
+            return row;
+        };
+
+        StateSet startSet(n);
+        closures.addTo(nfa.startStateId, startSet);
+        int32_t start = intern({ { startSet }, false });
+
+        // 2. Subset construction over the groups; a fresh youngest group joins
+        // after every byte until something has matched
+        for (size_t r = 0; r < states.size(); r++) {
+            for (int k = 0; k < classCount; k++) {
+                unsigned char b = symbolFirst[k];
+                const Groups& from = states[r];
+                Groups to{ {}, from.matched };
+                StateSet seen(n);
+
+                for (const auto& group : from.sets) {
+                    StateSet moved(n);
+                    group.forEach([&](int s) {
+                        for (const auto& t : nfa.states[s].transitions) {
+                            if (!t.matches((char)b)) continue;
+                            closures.forEach(t.targetStateId, [&](int u) {
+                                if (!seen.contains(u)) { seen.insert(u); moved.insert(u); }
+                            });
+                        }
+                    });
+                    if (!moved.empty()) to.sets.push_back(std::move(moved));
+                }
+                if (!to.matched) {
+                    StateSet fresh(n);
+                    startSet.forEach([&](int u) { if (!seen.contains(u)) fresh.insert(u); });
+                    if (!fresh.empty()) to.sets.push_back(std::move(fresh));
+                }
+
+                int32_t target = intern(std::move(to));
+                table[(r + 1) * classCount + k] = target;
+            }
+        }
+
+        return CompiledDFA::fromTables((int)states.size() + 1, classCount, start, byteClass, table.data(), acceptTokens.data());
+    }
+
+    RegexSearch::RegexSearch(const std::string& regex) : prefilter(Prefilter::None), crossesLines(false) {
+        NFA nfa = RegexParser::toNFA(RegexParser::toPostfix(regex), NFAConstruction::Glushkov);
+        forward = leftmostDFA(nfa);
+        DFA backwards = RegexParser::toDFA(reverseNFA(nfa), TOKEN_UNKNOWN);
+        backwards.minimize();
+        reverse = CompiledDFA::compile(backwards);
+        literals = RegexParser::extractLiterals(regex);
+
+        for (int32_t s = 1; s < reverse.getStateCount(); s++) {
+            if (reverse.next(s, '\n') != CompiledDFA::DEAD_STATE) crossesLines = true;
+        }
+
+        // 1. Pick the prefilter: a required prefix pins down the start exactly,
+        // a factor only narrows it down
+        bool exact = true;
+        const std::vector<std::string>* set = nullptr;
+        if (literals.nullable) return;
+        if (!literals.prefixes.empty()) {
+            prefilter = Prefilter::Prefix;
+            set = &literals.prefixes;
+        } else if (!literals.factors.empty()) {
+            prefilter = Prefilter::Factor;
+            set = &literals.factors;
+        }
+
+        std::bitset<256> first;
+        if (set) {
+            for (const auto& s : *set) first.set((unsigned char)s[0]);
+            startBytes = toRanges(first, exact);
+            return;
+        }
+
+        // 2. No literals: the bytes a match can begin with, if that rules anything out
+        for (const auto& t : nfa.states[nfa.startStateId].transitions) {
+            for (int b = t.firstByte(); b <= t.lastByte(); b++) first.set(b);
+        }
+        startBytes = toRanges(first, exact);
+        if (exact && first.any() && !first.all()) prefilter = Prefilter::StartBytes;
+    }
+
+    size_t RegexSearch::findAny(const char* data, size_t length, size_t from, const std::vector<std::string>& set) const {
+        if (set.size() == 1) {
+            return from + ScanKernels::findLiteral(data + from, length - from, set[0].data(), set[0].length());
+        }
+
+        // Several strings: jump to a possible first byte, then compare
+        while (from < length) {
+            size_t p = from + ScanKernels::findByte(data + from, length - from, startBytes);
+            if (p == length) break;
+            for (const auto& s : set) {
+                if (s.length() <= length - p && memcmp(data + p, s.data(), s.length()) == 0) return p;
+            }
+            from = p + 1;
+        }
+        return length;
+    }
+
+    size_t RegexSearch::nextCandidate(const char* data, size_t length, size_t from) const {
+        if (prefilter == Prefilter::Prefix) return findAny(data, length, from, literals.prefixes);
+        if (prefilter == Prefilter::StartBytes) return from + ScanKernels::findByte(data + from, length - from, startBytes);
+        return from;
+    }
+
+    bool RegexSearch::search(const char* data, size_t length, size_t from, size_t& matchStart, size_t& matchLength) const {
+        const bool skip = (prefilter == Prefilter::Prefix || prefilter == Prefilter::StartBytes);
+        const int32_t start = forward.getStartState();
+
+        // 1. Forward: end of the leftmost-longest match. Whenever the DFA is back
+        // in its start state no thread is alive, so the prefilter may jump ahead,
+        // and the match cannot begin before that point.
+        size_t i = skip ? nextCandidate(data, length, from) : from;
+        size_t earliest = i;
+        size_t end = forward.isAccepting(start) ? i : NONE;
+        int32_t state = start;
+        while (i < length) {
+            state = forward.next(state, (unsigned char)data[i++]);
+            if (state == CompiledDFA::DEAD_STATE) break;
+            if (forward.isAccepting(state)) {
+                end = i;
+            } else if (state == start) {
+                if (skip) i = nextCandidate(data, length, i);
+                earliest = i;
+            }
+        }
+        if (end == NONE) return false;
+
+        // 2. Backward from the end: the longest reverse match reaches the start
+        int32_t r = reverse.getStartState();
+        size_t begin = reverse.isAccepting(r) ? end : NONE;
+        for (size_t j = end; j > earliest; j--) {
+            r = reverse.next(r, (unsigned char)data[j - 1]);
+            if (r == CompiledDFA::DEAD_STATE) break;
+            if (reverse.isAccepting(r)) begin = j - 1;
+        }
+        if (begin == NONE) return false;
+
+        matchStart = begin;
+        matchLength = end - begin;
+        return true;
+    }
+
+    bool RegexSearch::find(const char* data, size_t length, size_t from, size_t& matchStart, size_t& matchLength) const {
+        if (forward.empty() || from > length) return false;
+        if (prefilter != Prefilter::Factor) return search(data, length, from, matchStart, matchLength);
+
+        // No factor left: no match either
+        if (crossesLines) {
+            if (findAny(data, length, from, literals.factors) == length) return false;
+            return search(data, length, from, matchStart, matchLength);
+        }
+
+        // A match lies within one line, and only lines with a factor can hold one
+        while (from < length) {
+            size_t f = findAny(data, length, from, literals.factors);
+            if (f == length) return false;
+            size_t lineStart = f;
+            while (lineStart > from && data[lineStart - 1] != '\n') lineStart--;
+            const void* newline = memchr(data + f, '\n', length - f);
+            size_t lineEnd = newline ? (size_t)((const char*)newline - data) : length;
+            if (search(data, lineEnd, lineStart, matchStart, matchLength)) return true;
+            from = lineEnd + 1;
+        }
+        return false;
+    }
+
+    std::vector<RegexSearch::Match> RegexSearch::findAll(const char* data, size_t length) const {
+        std::vector<Match> matches;
+        size_t from = 0, start, count;
+        while (from <= length && find(data, length, from, start, count)) {
+            matches.push_back({ start, count });
+            from = start + count + (count == 0 ? 1 : 0);
+        }
+        return matches;
+    }
+
+}
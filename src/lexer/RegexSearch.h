@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "CompiledDFA.h"
+#include "RegexParser.h"
+#include "ScanKernels.h"
+
+namespace Automata {
+
+    // Unanchored search for a regex in a buffer: leftmost-longest,
+    // non-overlapping matches in one pass instead of restarting a DFA at
+    // every byte.
+    //
+    // Two automata do the work:
+    //  - forward: the unanchored (.*R) DFA, where every DFA state keeps its NFA
+    //    threads grouped by start position, oldest first. Once a group accepts,
+    //    younger groups are dropped and no new threads start, so the last
+    //    accepting position is the end of the leftmost-longest match.
+    //  - reverse: R reversed, anchored. Run backwards from that end, its
+    //    longest match gives the match start.
+    //
+    // Before and between matches the forward scan skips ahead using the
+    // literals from RegexParser::extractLiterals:
+    //  - Prefix:     every match starts with one of a few strings, so the DFA
+    //                only runs from their occurrences (findLiteral / findByte)
+    //  - Factor:     every match contains one of a few strings. If the regex
+    //                cannot match a newline only lines holding one are scanned,
+    //                and the search stops as soon as none is left.
+    //  - StartBytes: no literals, but a match must begin with one of a few byte ranges
+    class RegexSearch {
+    public:
+        enum class Prefilter { None, StartBytes, Prefix, Factor };
+
+        struct Match {
+            size_t start;
+            size_t length;
+        };
+
+        // Throws like RegexParser (std::length_error past MAX_DFA_STATES)
+        explicit RegexSearch(const std::string& regex);
+
+        // Leftmost-longest match starting in [from, length). False if there is none.
+        bool find(const char* data, size_t length, size_t from, size_t& matchStart, size_t& matchLength) const;
+        bool find(const std::string& text, size_t from, size_t& matchStart, size_t& matchLength) const {
+            return find(text.data(), text.length(), from, matchStart, matchLength);
+        }
+
+        // Every non-overlapping match, left to right. After an empty match the
+        // search resumes one byte further on.
+        std::vector<Match> findAll(const char* data, size_t length) const;
+        std::vector<Match> findAll(const std::string& text) const { return findAll(text.data(), text.length()); }
+
+        const RegexLiterals& getLiterals() const { return literals; }
+        const CompiledDFA& getForwardDFA() const { return forward; }
+        const CompiledDFA& getReverseDFA() const { return reverse; }
+        Prefilter getPrefilter() const { return prefilter; }
+
+    private:
+        CompiledDFA forward;
+        CompiledDFA reverse;
+        RegexLiterals literals;
+        Prefilter prefilter;
+        ScanKernels::ByteRanges startBytes; // First bytes of the literals (Prefix / Factor) or of a match
+        bool crossesLines;                  // Some match can contain '\n'
+
+        // Earliest position in [from, length) where a match can start, length if none
+        size_t nextCandidate(const char* data, size_t length, size_t from) const;
+        // Earliest occurrence at or after from of any string in set, length if none
+        size_t findAny(const char* data, size_t length, size_t from, const std::vector<std::string>& set) const;
+        // Leftmost-longest match inside data[from, length)
+        bool search(const char* data, size_t length, size_t from, size_t& matchStart, size_t& matchLength) const;
+    };
+
+}
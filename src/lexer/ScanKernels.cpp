@@ -0,0 +1,361 @@
+#include "ScanKernels.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUTOMATA_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AUTOMATA_TARGET_AVX2
+#else
+#define AUTOMATA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define AUTOMATA_SIMD_X86 0
+#endif
+
+namespace Automata {
+namespace ScanKernels {
+
+    namespace {
+
+        inline bool isSpaceByte(unsigned char c) {
+            return c == ' ' || (c >= '\t' && c <= '\r');
+        }
+
+        inline bool inRanges(unsigned char c, const ByteRanges& ranges) {
+            for (int r = 0; r < ranges.count; r++) {
+                if (c >= ranges.lo[r] && c <= ranges.hi[r]) return true;
+            }
+            return false;
+        }
+
+        inline int lowestSetBit(uint32_t mask) {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return (int)index;
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+
+        inline int popCount(uint32_t mask) {
+#ifdef _MSC_VER
+            return (int)__popcnt(mask);
+#else
+            return __builtin_popcount(mask);
+#endif
+        }
+
+        // --- Scalar ---
+
+        size_t skipWhitespaceScalar(const char* data, size_t length, int& newlines) {
+            size_t i = 0;
+            newlines = 0;
+            while (i < length && isSpaceByte((unsigned char)data[i])) {
+                if (data[i] == '\n') newlines++;
+                i++;
+            }
+            return i;
+        }
+
+        size_t skipRunScalar(const char* data, size_t length, const ByteRanges& ranges) {
+            size_t i = 0;
+            while (i < length && inRanges((unsigned char)data[i], ranges)) i++;
+            return i;
+        }
+
+        size_t countNewlinesScalar(const char* data, size_t length) {
+            size_t n = 0;
+            for (size_t i = 0; i < length; i++) n += (data[i] == '\n');
+            return n;
+        }
+
+        size_t findByteScalar(const char* data, size_t length, const ByteRanges& ranges) {
+            size_t i = 0;
+            while (i < length && !inRanges((unsigned char)data[i], ranges)) i++;
+            return i;
+        }
+
+        size_t findLiteralScalar(const char* data, size_t length, const char* needle, size_t needleLength) {
+            if (needleLength == 0) return 0;
+            if (needleLength > length) return length;
+            const char* end = data + length - needleLength + 1;
+            for (const char* p = data; p < end; p++) {
+                p = (const char*)memchr(p, needle[0], end - p);
+                if (!p) break;
+                if (memcmp(p + 1, needle + 1, needleLength - 1) == 0) return p - data;
+            }
+            return length;
+        }
+
+#if AUTOMATA_SIMD_X86
+        // Unsigned "lo <= v <= hi" per byte: (v - lo) <= (hi - lo) via min_epu8
+
+        // --- SSE2 (16 bytes per step) ---
+
+        inline __m128i spaceMask128(__m128i v) {
+            __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+            __m128i ctrl = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+            return _mm_or_si128(ctrl, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+        }
+
+        inline __m128i rangeMask128(__m128i v, const ByteRanges& ranges) {
+            __m128i hit = _mm_setzero_si128();
+            for (int r = 0; r < ranges.count; r++) {
+                __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8((char)ranges.lo[r]));
+                __m128i span = _mm_set1_epi8((char)(ranges.hi[r] - ranges.lo[r]));
+                hit = _mm_or_si128(hit, _mm_cmpeq_epi8(_mm_min_epu8(shifted, span), shifted));
+            }
+            return hit;
+        }
+
+        size_t skipWhitespaceSSE2(const char* data, size_t length, int& newlines) {
+            size_t i = 0;
+            newlines = 0;
+            const __m128i nl = _mm_set1_epi8('\n');
+            for (; i + 16 <= length; i += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+                uint32_t space = (uint32_t)_mm_movemask_epi8(spaceMask128(v));
+                uint32_t lines = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+                if (space != 0xFFFF) {
+                    int end = lowestSetBit(~space);
+                    newlines += popCount(lines & ((1u << end) - 1));
+                    return i + end;
+                }
+                newlines += popCount(lines);
+            }
+            int tail = 0;
+            size_t rest = skipWhitespaceScalar(data + i, length - i, tail);
+            newlines += tail;
+            return i + rest;
+        }
+
+        size_t skipRunSSE2(const char* data, size_t length, const ByteRanges& ranges) {
+            size_t i = 0;
+            for (; i + 16 <= length; i += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+                uint32_t hit = (uint32_t)_mm_movemask_epi8(rangeMask128(v, ranges));
+                if (hit != 0xFFFF) return i + lowestSetBit(~hit);
+            }
+            return i + skipRunScalar(data + i, length - i, ranges);
+        }
+
+        size_t countNewlinesSSE2(const char* data, size_t length) {
+            size_t i = 0, n = 0;
+            const __m128i nl = _mm_set1_epi8('\n');
+            for (; i + 16 <= length; i += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+                n += popCount((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+            }
+            return n + countNewlinesScalar(data + i, length - i);
+        }
+
+        size_t findByteSSE2(const char* data, size_t length, const ByteRanges& ranges) {
+            size_t i = 0;
+            for (; i + 16 <= length; i += 16) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+                uint32_t hit = (uint32_t)_mm_movemask_epi8(rangeMask128(v, ranges));
+                if (hit) return i + lowestSetBit(hit);
+            }
+            return i + findByteScalar(data + i, length - i, ranges);
+        }
+
+        size_t findLiteralSSE2(const char* data, size_t length, const char* needle, size_t needleLength) {
+            if (needleLength < 2 || needleLength > length) return findLiteralScalar(data, length, needle, needleLength);
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last = _mm_set1_epi8(needle[needleLength - 1]);
+            const size_t limit = length - needleLength + 1; // Candidate starts are [0, limit)
+            size_t i = 0;
+            for (; i + 16 <= limit; i += 16) {
+                __m128i a = _mm_loadu_si128((const __m128i*)(data + i));
+                __m128i b = _mm_loadu_si128((const __m128i*)(data + i + needleLength - 1));
+                uint32_t candidates = (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+                while (candidates) {
+                    int k = lowestSetBit(candidates);
+                    if (memcmp(data + i + k + 1, needle + 1, needleLength - 2) == 0) return i + k;
+                    candidates &= candidates - 1;
+                }
+            }
+            size_t rest = findLiteralScalar(data + i, length - i, needle, needleLength);
+            return (rest == length - i) ? length : i + rest;
+        }
+
+        // --- AVX2 (32 bytes per step) ---
+
+        AUTOMATA_TARGET_AVX2 size_t skipWhitespaceAVX2(const char* data, size_t length, int& newlines) {
+            size_t i = 0;
+            newlines = 0;
+            const __m256i tab = _mm256_set1_epi8('\t');
+            const __m256i span = _mm256_set1_epi8('\r' - '\t');
+            const __m256i sp = _mm256_set1_epi8(' ');
+            const __m256i nl = _mm256_set1_epi8('\n');
+            for (; i + 32 <= length; i += 32) {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+                __m256i shifted = _mm256_sub_epi8(v, tab);
+                __m256i ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, span), shifted);
+                uint32_t space = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(ctrl, _mm256_cmpeq_epi8(v, sp)));
+                uint32_t lines = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl));
+                if (space != 0xFFFFFFFFu) {
+                    int end = lowestSetBit(~space);
+                    newlines += popCount(lines & ((1u << end) - 1));
+                    return i + end;
+                }
+                newlines += popCount(lines);
+            }
+            int tail = 0;
+            size_t rest = skipWhitespaceSSE2(data + i, length - i, tail);
+            newlines += tail;
+            return i + rest;
+        }
+
+        AUTOMATA_TARGET_AVX2 size_t skipRunAVX2(const char* data, size_t length, const ByteRanges& ranges) {
+            size_t i = 0;
+            for (; i + 32 <= length; i += 32) {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+                __m256i hit = _mm256_setzero_si256();
+                for (int r = 0; r < ranges.count; r++) {
+                    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8((char)ranges.lo[r]));
+                    __m256i span = _mm256_set1_epi8((char)(ranges.hi[r] - ranges.lo[r]));
+                    hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, span), shifted));
+                }
+                uint32_t mask = (uint32_t)_mm256_movemask_epi8(hit);
+                if (mask != 0xFFFFFFFFu) return i + lowestSetBit(~mask);
+            }
+            return i + skipRunSSE2(data + i, length - i, ranges);
+        }
+
+        AUTOMATA_TARGET_AVX2 size_t countNewlinesAVX2(const char* data, size_t length) {
+            size_t i = 0, n = 0;
+            const __m256i nl = _mm256_set1_epi8('\n');
+            for (; i + 32 <= length; i += 32) {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+                n += popCount((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl)));
+            }
+            return n + countNewlinesSSE2(data + i, length - i);
+        }
+
+        AUTOMATA_TARGET_AVX2 size_t findByteAVX2(const char* data, size_t length, const ByteRanges& ranges) {
+            size_t i = 0;
+            for (; i + 32 <= length; i += 32) {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+                __m256i hit = _mm256_setzero_si256();
+                for (int r = 0; r < ranges.count; r++) {
+                    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8((char)ranges.lo[r]));
+                    __m256i span = _mm256_set1_epi8((char)(ranges.hi[r] - ranges.lo[r]));
+                    hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, span), shifted));
+                }
+                uint32_t mask = (uint32_t)_mm256_movemask_epi8(hit);
+                if (mask) return i + lowestSetBit(mask);
+            }
+            return i + findByteSSE2(data + i, length - i, ranges);
+        }
+
+        AUTOMATA_TARGET_AVX2 size_t findLiteralAVX2(const char* data, size_t length, const char* needle, size_t needleLength) {
+            if (needleLength < 2 || needleLength > length) return findLiteralScalar(data, length, needle, needleLength);
+            const __m256i first = _mm256_set1_epi8(needle[0]);
+            const __m256i last = _mm256_set1_epi8(needle[needleLength - 1]);
+            const size_t limit = length - needleLength + 1;
+            size_t i = 0;
+            for (; i + 32 <= limit; i += 32) {
+                __m256i a = _mm256_loadu_si256((const __m256i*)(data + i));
+                __m256i b = _mm256_loadu_si256((const __m256i*)(data + i + needleLength - 1));
+                uint32_t candidates = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+                while (candidates) {
+                    int k = lowestSetBit(candidates);
+                    if (memcmp(data + i + k + 1, needle + 1, needleLength - 2) == 0) return i + k;
+                    candidates &= candidates - 1;
+                }
+            }
+            size_t rest = findLiteralSSE2(data + i, length - i, needle, needleLength);
+            return (rest == length - i) ? length : i + rest;
+        }
+
+        bool cpuHasAVX2() {
+#ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7) return false;
+            __cpuid(info, 1);
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            bool avx = (info[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx) return false;
+            if ((_xgetbv(0) & 0x6) != 0x6) return false; // OS saves YMM state
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+#endif
+
+        struct Dispatch {
+            size_t (*skipWhitespace)(const char*, size_t, int&);
+            size_t (*skipRun)(const char*, size_t, const ByteRanges&);
+            size_t (*countNewlines)(const char*, size_t);
+            size_t (*findByte)(const char*, size_t, const ByteRanges&);
+            size_t (*findLiteral)(const char*, size_t, const char*, size_t);
+            const char* name;
+
+            Dispatch() {
+#if AUTOMATA_SIMD_X86
+                if (cpuHasAVX2()) {
+                    skipWhitespace = skipWhitespaceAVX2;
+                    skipRun = skipRunAVX2;
+                    countNewlines = countNewlinesAVX2;
+                    findByte = findByteAVX2;
+                    findLiteral = findLiteralAVX2;
+                    name = "avx2";
+                } else {
+                    skipWhitespace = skipWhitespaceSSE2;
+                    skipRun = skipRunSSE2;
+                    countNewlines = countNewlinesSSE2;
+                    findByte = findByteSSE2;
+                    findLiteral = findLiteralSSE2;
+                    name = "sse2";
+                }
+#else
+                skipWhitespace = skipWhitespaceScalar;
+                skipRun = skipRunScalar;
+                countNewlines = countNewlinesScalar;
+                findByte = findByteScalar;
+                findLiteral = findLiteralScalar;
+                name = "scalar";
+#endif
+            }
+        };
+
+        const Dispatch& kernels() {
+            static const Dispatch dispatch;
+            return dispatch;
+        }
+    }
+
+    size_t skipWhitespace(const char* data, size_t length, int& newlines) {
+        return kernels().skipWhitespace(data, length, newlines);
+    }
+
+    size_t skipRun(const char* data, size_t length, const ByteRanges& ranges) {
+        return kernels().skipRun(data, length, ranges);
+    }
+
+    size_t countNewlines(const char* data, size_t length) {
+        return kernels().countNewlines(data, length);
+    }
+
+    size_t findByte(const char* data, size_t length, const ByteRanges& ranges) {
+        return kernels().findByte(data, length, ranges);
+    }
+
+    size_t findLiteral(const char* data, size_t length, const char* needle, size_t needleLength) {
+        return kernels().findLiteral(data, length, needle, needleLength);
+    }
+
+    const char* activeKernel() {
+        return kernels().name;
+    }
+
+}
+}
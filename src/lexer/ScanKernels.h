@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+
+namespace Automata {
+
+    // Bulk byte-scanning kernels for the lexer's hot loops. Each one has a scalar
+    // fallback plus SSE2/AVX2 versions on x86; the widest one the CPU supports is
+    // picked once at first use.
+    namespace ScanKernels {
+
+        // Up to MAX_RUN_RANGES inclusive byte ranges, e.g. [0-9][A-Z][_][a-z] for an identifier loop
+        static constexpr int MAX_RUN_RANGES = 4;
+        struct ByteRanges {
+            int count = 0;
+            unsigned char lo[MAX_RUN_RANGES] = {};
+            unsigned char hi[MAX_RUN_RANGES] = {};
+        };
+
+        // Length of the whitespace run at data (isspace in the "C" locale);
+        // newlines receives the number of '\n' bytes inside the run
+        size_t skipWhitespace(const char* data, size_t length, int& newlines);
+
+        // Length of the run of bytes at data that fall inside ranges
+        size_t skipRun(const char* data, size_t length, const ByteRanges& ranges);
+
+        // Number of '\n' bytes in [data, data + length)
+        size_t countNewlines(const char* data, size_t length);
+
+        // Index of the first byte inside ranges, or length if there is none (memchr for byte sets)
+        size_t findByte(const char* data, size_t length, const ByteRanges& ranges);
+
+        // Index of the first occurrence of needle, or length if there is none (memmem).
+        // Candidates are positions where both the first and the last needle byte match.
+        size_t findLiteral(const char* data, size_t length, const char* needle, size_t needleLength);
+
+        // "avx2", "sse2" or "scalar"
+        const char* activeKernel();
+    }
+
+}
@@ -0,0 +1,225 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "FA.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Automata {
+
+    // Fixed-size bitset over NFA state ids. Used as the subset representation
+    // during determinization, where union is a word-wise OR and equality /
+    // hashing work on whole words.
+    class StateSet {
+    public:
+        StateSet() {}
+        explicit StateSet(int stateCount) : words((stateCount + 63) / 64, 0) {}
+
+        void insert(int s) { words[s >> 6] |= (uint64_t)1 << (s & 63); }
+        bool contains(int s) const { return (words[s >> 6] >> (s & 63)) & 1; }
+
+        void unite(const StateSet& other) {
+            for (size_t w = 0; w < words.size(); w++) words[w] |= other.words[w];
+        }
+
+        void clear() { std::fill(words.begin(), words.end(), 0); }
+
+        bool empty() const {
+            for (uint64_t w : words) if (w) return false;
+            return true;
+        }
+
+        // Calls fn(stateId) for every member in ascending order
+        template <typename Fn>
+        void forEach(Fn fn) const {
+            for (size_t w = 0; w < words.size(); w++) {
+                uint64_t bits = words[w];
+                while (bits) {
+                    int b = lowestBit(bits);
+                    fn((int)(w * 64 + b));
+                    bits &= bits - 1;
+                }
+            }
+        }
+
+        bool operator==(const StateSet& other) const { return words == other.words; }
+
+        struct Hash {
+            size_t operator()(const StateSet& set) const {
+                uint64_t h = 1469598103934665603ull; // FNV-1a over words
+                for (uint64_t w : set.words) {
+                    h ^= w;
+                    h *= 1099511628211ull;
+                }
+                return (size_t)(h ^ (h >> 32));
+            }
+        };
+
+    private:
+        std::vector<uint64_t> words;
+
+        static int lowestBit(uint64_t bits) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward64(&index, bits);
+            return (int)index;
+#else
+            return __builtin_ctzll(bits);
+#endif
+        }
+    };
+
+    // Epsilon closure of every NFA state, computed once per NFA. Epsilon cycles
+    // (the back edges of * and +) are first collapsed with Tarjan's SCC
+    // algorithm, so all states of a cycle share one closure, and each
+    // component's closure is built from its successors' in a single pass.
+    //
+    // That costs one StateSet per component, i.e. up to n^2 / 8 bytes. Above
+    // MAX_PRECOMPUTED_BYTES (about 16000 components) nothing is stored and each
+    // closure is walked on demand instead: slower per lookup, linear memory.
+    class EpsilonClosures {
+    public:
+        static constexpr size_t MAX_PRECOMPUTED_BYTES = 32 * 1024 * 1024;
+
+        explicit EpsilonClosures(const NFA& nfa, size_t maxPrecomputedBytes = MAX_PRECOMPUTED_BYTES)
+            : nfa(nfa), stateCount((int)nfa.states.size()) {
+            // 1. Strongly connected components over epsilon edges. Tarjan emits
+            // them in reverse topological order: every component reachable
+            // from the current one is already finished.
+            component.assign(stateCount, -1);
+            std::vector<std::vector<int>> members;
+            findComponents(members);
+
+            size_t setBytes = (size_t)(stateCount + 63) / 64 * sizeof(uint64_t);
+            if (members.size() * setBytes > maxPrecomputedBytes) {
+                mark.assign(stateCount, 0);
+                return;
+            }
+
+            // 2. Closure(C) = members(C) + closure of every component C reaches
+            componentClosure.assign(members.size(), StateSet(stateCount));
+            for (int c = 0; c < (int)members.size(); c++) {
+                StateSet& closure = componentClosure[c];
+                for (int s : members[c]) {
+                    closure.insert(s);
+                    for (const auto& t : nfa.states[s].transitions) {
+                        if (t.input != '\0') continue;
+                        int target = component[t.targetStateId];
+                        if (target != c) closure.unite(componentClosure[target]);
+                    }
+                }
+            }
+            precomputed = true;
+        }
+
+        // Adds the closure of state to set
+        void addTo(int state, StateSet& set) const {
+            if (precomputed) set.unite(componentClosure[component[state]]);
+            else forEach(state, [&](int s) { set.insert(s); });
+        }
+
+        // Calls fn(stateId) once for every state in the closure of state
+        // (ascending when precomputed, in walk order otherwise)
+        template <typename Fn>
+        void forEach(int state, Fn fn) const {
+            if (precomputed) {
+                componentClosure[component[state]].forEach(fn);
+                return;
+            }
+
+            // Depth-first walk; mark[s] == epoch means s was already reported
+            if (++epoch == 0) {
+                std::fill(mark.begin(), mark.end(), 0);
+                epoch = 1;
+            }
+            stack.push_back(state);
+            mark[state] = epoch;
+            while (!stack.empty()) {
+                int s = stack.back(); stack.pop_back();
+                fn(s);
+                for (const auto& t : nfa.states[s].transitions) {
+                    if (t.input != '\0' || mark[t.targetStateId] == epoch) continue;
+                    mark[t.targetStateId] = epoch;
+                    stack.push_back(t.targetStateId);
+                }
+            }
+        }
+
+        bool isPrecomputed() const { return precomputed; }
+        int getStateCount() const { return stateCount; }
+
+    private:
+        const NFA& nfa;
+        int stateCount;
+        std::vector<int> component;             // SCC of every state
+        std::vector<StateSet> componentClosure; // Indexed by SCC, if precomputed
+        bool precomputed = false;
+
+        // On-demand walk scratch (not thread-safe, like the rest of a construction)
+        mutable std::vector<uint32_t> mark;
+        mutable uint32_t epoch = 0;
+        mutable std::vector<int> stack;
+
+        // Iterative Tarjan (NFAs for long rules are too deep for recursion)
+        void findComponents(std::vector<std::vector<int>>& members) {
+            std::vector<int> index(stateCount, -1), low(stateCount, 0);
+            std::vector<char> onStack(stateCount, 0);
+            std::vector<int> stack;
+            std::vector<std::pair<int, size_t>> work; // (state, next transition to look at)
+            int counter = 0;
+
+            for (int root = 0; root < stateCount; root++) {
+                if (index[root] != -1) continue;
+                work.push_back({ root, 0 });
+
+                while (!work.empty()) {
+                    int v = work.back().first;
+                    size_t& edge = work.back().second;
+
+                    if (edge == 0 && index[v] == -1) {
+                        index[v] = low[v] = counter++;
+                        stack.push_back(v);
+                        onStack[v] = 1;
+                    }
+
+                    const auto& transitions = nfa.states[v].transitions;
+                    bool descended = false;
+                    while (edge < transitions.size()) {
+                        const Transition& t = transitions[edge++];
+                        if (t.input != '\0') continue;
+                        int w = t.targetStateId;
+                        if (index[w] == -1) {
+                            work.push_back({ w, 0 });
+                            descended = true;
+                            break;
+                        }
+                        if (onStack[w]) low[v] = std::min(low[v], index[w]);
+                    }
+                    if (descended) continue;
+
+                    // v is finished: pop its component if it is a root
+                    if (low[v] == index[v]) {
+                        int c = (int)members.size();
+                        members.emplace_back();
+                        int w;
+                        do {
+                            w = stack.back(); stack.pop_back();
+                            onStack[w] = 0;
+                            component[w] = c;
+                            members[c].push_back(w);
+                        } while (w != v);
+                    }
+                    work.pop_back();
+                    if (!work.empty()) {
+                        int parent = work.back().first;
+                        low[parent] = std::min(low[parent], low[v]);
+                    }
+                }
+            }
+        }
+    };
+
+}
@@ -0,0 +1,105 @@
+#include "StreamLexer.h"
+#include <vector>
+#include "ScanKernels.h"
+#include "Utf8.h"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Automata {
+
+    StreamLexer::StreamLexer(Lexer& lexer, TokenCallback onToken)
+        : lexer(lexer), onToken(std::move(onToken)), pendingOffset(0), line(1) {}
+
+    void StreamLexer::feed(const char* data, size_t length) {
+        pending.append(data, length);
+        drain(false);
+    }
+
+    void StreamLexer::finish() {
+        drain(true);
+        onToken({ TOKEN_EOF, pendingOffset, 0, line }, std::string_view());
+    }
+
+    void StreamLexer::drain(bool atEnd) {
+        size_t cursor = 0;
+
+        while (cursor < pending.length()) {
+            int newlines = 0;
+            size_t spaces = ScanKernels::skipWhitespace(pending.data() + cursor, pending.length() - cursor, newlines);
+            if (spaces > 0) {
+                line += newlines;
+                cursor += spaces;
+                continue;
+            }
+
+            TokenType bestType = TOKEN_INVALID;
+            bool reachedEnd = false;
+            size_t bestLen;
+            if (lexer.canResumeMatch()) {
+                // Only the token at pending[0] can have a walk in progress
+                if (!walking || cursor > 0) walk = lexer.beginMatch();
+                reachedEnd = lexer.continueMatch(walk, pending.data() + cursor, pending.length() - cursor);
+                walking = false;
+                bestLen = lexer.matchResult(walk, bestType);
+            } else {
+                if (!atEnd && pending.length() - cursor < retryBytes) break;
+                bestLen = lexer.matchToken(pending.data() + cursor, pending.length() - cursor, bestType, &reachedEnd);
+                retryBytes = 0;
+            }
+
+            // The DFA is still alive at the end of the chunk: the next chunk could
+            // make this token longer, so keep it (and its backtrack window) for later
+            if (reachedEnd && !atEnd) {
+                walking = true;
+                retryBytes = 2 * (pending.length() - cursor);
+                break;
+            }
+
+            if (bestLen == 0) {
+                // Wait for the rest of a character split across chunks
+                bool truncated = false;
+                bestType = TOKEN_UNKNOWN;
+                bestLen = Utf8::sequenceLength(pending.data() + cursor, pending.length() - cursor, &truncated);
+                if (truncated && !atEnd) break;
+                if (bestLen == 0) bestLen = 1;
+            }
+            onToken({ bestType, pendingOffset + cursor, bestLen, line }, std::string_view(pending.data() + cursor, bestLen));
+            cursor += bestLen;
+        }
+
+        pending.erase(0, cursor);
+        pendingOffset += cursor;
+    }
+
+    bool StreamLexer::feedStream(std::istream& in, size_t chunkSize) {
+        std::vector<char> chunk(chunkSize);
+        while (in) {
+            in.read(chunk.data(), (std::streamsize)chunk.size());
+            std::streamsize got = in.gcount();
+            if (got > 0) feed(chunk.data(), (size_t)got);
+        }
+        finish();
+        return !in.bad();
+    }
+
+    bool StreamLexer::feedFd(int fd, size_t chunkSize) {
+        std::vector<char> chunk(chunkSize);
+        bool ok = true;
+        while (true) {
+#ifdef _WIN32
+            int got = _read(fd, chunk.data(), (unsigned int)chunk.size());
+#else
+            ssize_t got = read(fd, chunk.data(), chunk.size());
+#endif
+            if (got == 0) break;
+            if (got < 0) { ok = false; break; }
+            feed(chunk.data(), (size_t)got);
+        }
+        finish();
+        return ok;
+    }
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <functional>
+#include <istream>
+#include "Lexer.h"
+
+namespace Automata {
+
+    // Incremental front end for Lexer: input arrives in chunks (from an istream,
+    // a file descriptor or feed()) and tokens are handed out as soon as they are
+    // final. Only the unfinished token - which is also the maximal-munch
+    // backtrack window - is carried across chunk boundaries, so memory stays
+    // bounded by chunk size + longest token regardless of input size.
+    class StreamLexer {
+    public:
+        // text is only valid for the duration of the call; span offsets are
+        // absolute positions in the stream
+        using TokenCallback = std::function<void(const TokenSpan& token, std::string_view text)>;
+
+        static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+        StreamLexer(Lexer& lexer, TokenCallback onToken);
+
+        // Push the next chunk of input
+        void feed(const char* data, size_t length);
+
+        // End of input: flush the carried-over token and emit TOKEN_EOF
+        void finish();
+
+        // Convenience drivers: read fixed-size chunks until EOF, then finish().
+        // Return false on a read error (tokens seen so far were still emitted).
+        bool feedStream(std::istream& in, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+        bool feedFd(int fd, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+        // Bytes currently held back waiting for more input
+        size_t getCarriedBytes() const { return pending.size(); }
+
+    private:
+        Lexer& lexer;
+        TokenCallback onToken;
+
+        std::string pending;   // Unconsumed input, pending[0] is at stream offset pendingOffset
+        size_t pendingOffset;
+        int line;
+
+        // The unfinished token at pending[0]: its match so far, continued by the
+        // next drain rather than rescanned. The over-budget fallback cannot be
+        // resumed; it rescans, but only once pending has doubled (retryBytes), so
+        // the rescans of one long token still add up to linear work.
+        Lexer::MatchWalk walk;
+        bool walking = false;
+        size_t retryBytes = 0;
+
+        // Emit every token that can no longer change; keeps the rest in pending
+        void drain(bool atEnd);
+    };
+
+}
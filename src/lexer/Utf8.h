@@ -0,0 +1,145 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Automata {
+
+    // UTF-8 helpers. The automata never decode: Unicode ranges in a regex are
+    // turned into byte-range sequences (rangeSequences) that the DFA walks like
+    // any other bytes.
+    namespace Utf8 {
+
+        static constexpr uint32_t MAX_CODE_POINT = 0x10FFFF;
+        static constexpr uint32_t SURROGATE_FIRST = 0xD800;
+        static constexpr uint32_t SURROGATE_LAST = 0xDFFF;
+
+        inline int encodedLength(uint32_t cp) {
+            return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+        }
+
+        // Appends the encoding of cp (assumed valid) to out
+        inline void encode(uint32_t cp, std::string& out) {
+            if (cp < 0x80) {
+                out += (char)cp;
+            } else if (cp < 0x800) {
+                out += (char)(0xC0 | (cp >> 6));
+                out += (char)(0x80 | (cp & 0x3F));
+            } else if (cp < 0x10000) {
+                out += (char)(0xE0 | (cp >> 12));
+                out += (char)(0x80 | ((cp >> 6) & 0x3F));
+                out += (char)(0x80 | (cp & 0x3F));
+            } else {
+                out += (char)(0xF0 | (cp >> 18));
+                out += (char)(0x80 | ((cp >> 12) & 0x3F));
+                out += (char)(0x80 | ((cp >> 6) & 0x3F));
+                out += (char)(0x80 | (cp & 0x3F));
+            }
+        }
+
+        // Length of the well-formed sequence at data (overlongs, surrogates and
+        // values past U+10FFFF rejected), or 0 if there is none. truncated is set
+        // when the bytes so far are a valid start but data ends too early.
+        inline size_t sequenceLength(const char* data, size_t length, bool* truncated = nullptr) {
+            if (truncated) *truncated = false;
+            if (length == 0) return 0;
+            unsigned char b0 = (unsigned char)data[0];
+            if (b0 < 0x80) return 1;
+
+            size_t need;
+            unsigned char lo = 0x80, hi = 0xBF; // Allowed range of the second byte
+            if (b0 >= 0xC2 && b0 <= 0xDF) need = 2;
+            else if (b0 >= 0xE0 && b0 <= 0xEF) {
+                need = 3;
+                if (b0 == 0xE0) lo = 0xA0;
+                if (b0 == 0xED) hi = 0x9F;
+            } else if (b0 >= 0xF0 && b0 <= 0xF4) {
+                need = 4;
+                if (b0 == 0xF0) lo = 0x90;
+                if (b0 == 0xF4) hi = 0x8F;
+            } else {
+                return 0;
+            }
+
+            for (size_t i = 1; i < need; i++) {
+                if (i >= length) {
+                    if (truncated) *truncated = true;
+                    return 0;
+                }
+                unsigned char b = (unsigned char)data[i];
+                if (b < (i == 1 ? lo : 0x80) || b > (i == 1 ? hi : 0xBF)) return 0;
+            }
+            return need;
+        }
+
+        // Decodes the well-formed sequence of length n at data
+        inline uint32_t decode(const char* data, size_t n) {
+            const unsigned char* b = (const unsigned char*)data;
+            if (n == 1) return b[0];
+            if (n == 2) return ((b[0] & 0x1F) << 6) | (b[1] & 0x3F);
+            if (n == 3) return ((b[0] & 0x0F) << 12) | ((b[1] & 0x3F) << 6) | (b[2] & 0x3F);
+            return ((b[0] & 0x07) << 18) | ((b[1] & 0x3F) << 12) | ((b[2] & 0x3F) << 6) | (b[3] & 0x3F);
+        }
+
+        // One inclusive byte range per position of an encoded sequence
+        struct ByteRange {
+            unsigned char lo;
+            unsigned char hi;
+        };
+        using Sequence = std::vector<ByteRange>;
+
+        // Byte-range sequences matching exactly the encodings of [first, last].
+        // The range is split where the encoded length changes and wherever the
+        // continuation bytes would not cover the full 80-BF span, so every
+        // sequence is a plain product of byte ranges (the Go / RE2 scheme).
+        // Surrogates are skipped.
+        inline void rangeSequences(uint32_t first, uint32_t last, std::vector<Sequence>& out) {
+            if (last > MAX_CODE_POINT) last = MAX_CODE_POINT;
+            if (first > last) return;
+
+            // 1. Surrogates have no encoding
+            if (first <= SURROGATE_LAST && last >= SURROGATE_FIRST) {
+                if (first < SURROGATE_FIRST) rangeSequences(first, SURROGATE_FIRST - 1, out);
+                if (last > SURROGATE_LAST) rangeSequences(SURROGATE_LAST + 1, last, out);
+                return;
+            }
+
+            // 2. One encoded length at a time
+            static const uint32_t lengthEnds[] = { 0x7F, 0x7FF, 0xFFFF };
+            for (uint32_t end : lengthEnds) {
+                if (first <= end && last > end) {
+                    rangeSequences(first, end, out);
+                    rangeSequences(end + 1, last, out);
+                    return;
+                }
+            }
+
+            // 3. Split until the low bits of each continuation byte run over their full span
+            int n = encodedLength(first);
+            for (int i = 1; i < n; i++) {
+                uint32_t mask = ((uint32_t)1 << (6 * i)) - 1;
+                if ((first & ~mask) != (last & ~mask)) {
+                    if ((first & mask) != 0) {
+                        rangeSequences(first, first | mask, out);
+                        rangeSequences((first | mask) + 1, last, out);
+                        return;
+                    }
+                    if ((last & mask) != mask) {
+                        rangeSequences(first, (last & ~mask) - 1, out);
+                        rangeSequences(last & ~mask, last, out);
+                        return;
+                    }
+                }
+            }
+
+            std::string a, b;
+            encode(first, a);
+            encode(last, b);
+            Sequence seq;
+            for (int i = 0; i < n; i++) seq.push_back({ (unsigned char)a[i], (unsigned char)b[i] });
+            out.push_back(seq);
+        }
+    }
+
+}
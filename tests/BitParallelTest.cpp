@@ -0,0 +1,82 @@
+// BitParallelMatcher must give the same anchored longest match, token and
+// liveness as the Pike VM on the same Glushkov NFAs, and refuse automata it
+// cannot represent.
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "BitParallelMatcher.h"
+#include "PikeVM.h"
+#include "RegexParser.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static std::mt19937 rng(7);
+
+static std::string randomRegex(int depth) {
+    static const char* atoms[] = { "a", "b", "c", "[a-c]", "[^a]", "\\d", "\\w", ".", "1", "_",
+                                   "[ab]{2}", "a{1,3}", "b{0}", "(ab){0,2}", "c{2,}", "\\{" };
+    switch (rng() % (depth > 3 ? 2 : 6)) {
+    case 0:
+    case 1: return atoms[rng() % (sizeof(atoms) / sizeof(atoms[0]))];
+    case 2: return randomRegex(depth + 1) + randomRegex(depth + 1);
+    case 3: return "(" + randomRegex(depth + 1) + "|" + randomRegex(depth + 1) + ")";
+    case 4: return "(" + randomRegex(depth + 1) + ")*";
+    default: return "(" + randomRegex(depth + 1) + ")+";
+    }
+}
+
+static NFA glushkov(const std::string& regex) {
+    return RegexParser::toNFA(RegexParser::toPostfix(regex), NFAConstruction::Glushkov);
+}
+
+int main() {
+    const char alphabet[] = "abc1_x{\n";
+    int compared = 0;
+
+    // 1. Random rule sets of 1-3 regexes against the Pike VM
+    for (int n = 0; n < 2000; n++) {
+        std::vector<NFA> rules;
+        std::vector<TokenType> types;
+        int ruleCount = 1 + rng() % 3;
+        for (int r = 0; r < ruleCount; r++) {
+            rules.push_back(glushkov(randomRegex(0)));
+            types.push_back((TokenType)(1 + r));
+        }
+        if (!BitParallelMatcher::supports(rules)) continue;
+        compared++;
+
+        BitParallelMatcher matcher(rules, types);
+        PikeVM vm(RegexParser::combineNFAs(rules), types);
+        for (int k = 0; k < 100; k++) {
+            std::string input;
+            int length = rng() % 12;
+            for (int i = 0; i < length; i++) input += alphabet[rng() % (sizeof(alphabet) - 1)];
+
+            TokenType vmType = TOKEN_INVALID, bpType = TOKEN_INVALID;
+            size_t vmIndex, bpIndex;
+            bool vmAlive = vm.simulate(input, vmType, vmIndex);
+            bool bpAlive = matcher.simulate(input, bpType, bpIndex);
+            if (!CHECK(vmAlive == bpAlive && vmIndex == bpIndex && (vmIndex == NO_MATCH || vmType == bpType))) {
+                fprintf(stderr, "  rule set %d, input \"%s\"\n", n, input.c_str());
+                break;
+            }
+        }
+    }
+    CHECK(compared > 1000);
+
+    // 2. Unsupported automata are refused
+    CHECK(!BitParallelMatcher::supports(RegexParser::toNFA(RegexParser::toPostfix("a*b")))); // Thompson: has epsilons
+    CHECK(!BitParallelMatcher::supports(glushkov("[a-z]{" + std::to_string(BitParallelMatcher::MAX_STATES) + "}")));
+    bool threw = false;
+    try {
+        BitParallelMatcher tooBig(glushkov("x{100}"), TOKEN_IDENTIFIER);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    return Test::result("BitParallelTest");
+}
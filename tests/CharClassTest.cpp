@@ -0,0 +1,82 @@
+// Character classes, ranges and escapes: each regex is checked for whole
+// matches of strings it must and must not accept, including the bracket
+// edge cases ([]a], [^]a], [a-], [-a]) and escapes inside and outside classes.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "RegexParser.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+struct Case {
+    std::string regex;
+    std::vector<std::string> accepted;
+    std::vector<std::string> rejected;
+};
+
+static bool wholeMatch(DFA& dfa, const std::string& input) {
+    int lastFinal, lastIndex;
+    dfa.simulate(input, lastFinal, lastIndex);
+    return lastIndex == (int)input.size();
+}
+
+int main() {
+    const std::vector<Case> cases = {
+        // Plain classes and ranges
+        { "[abc]", { "a", "b", "c" }, { "", "d", "ab", "[" } },
+        { "[a-cx-z]", { "a", "b", "c", "x", "z" }, { "d", "w", "-" } },
+        { "[0-9]+", { "0", "42", "9999" }, { "", "4a", "-1" } },
+        // ']' first is a member; '-' first or last is a literal
+        { "[]a]", { "]", "a" }, { "b", "[", "]a" } },
+        { "[^]a]", { "b", "[", "-" }, { "]", "a" } },
+        { "[a-]", { "a", "-" }, { "b", "" } },
+        { "[-a]", { "a", "-" }, { "b" } },
+        // Negation covers every other byte, newline included
+        { "[^a]", { "b", "\n", "\xFF", "\x01" }, { "a", "", "bb" } },
+        { "[^a-z]", { "A", "0", " " }, { "a", "m", "z" } },
+        // Escapes inside classes
+        { "[\\]]", { "]" }, { "\\", "" } },
+        { "[\\-a]", { "-", "a" }, { "b" } },
+        { "[a\\-z]", { "a", "-", "z" }, { "b", "y" } },
+        { "[\\\\]", { "\\" }, { "]" } },
+        { "[\\n\\t]", { "\n", "\t" }, { "n", "t", " " } },
+        { "[\\x41-\\x43]", { "A", "B", "C" }, { "D", "@" } },
+        // Class escapes and their negations, inside and outside brackets
+        { "\\d+", { "0", "123" }, { "a", "" } },
+        { "\\D", { "a", " " }, { "1" } },
+        { "\\w+", { "a_Z9" }, { "-", " " } },
+        { "\\W", { "-", " " }, { "a", "_", "5" } },
+        { "\\s", { " ", "\t", "\n", "\r" }, { "a" } },
+        { "\\S", { "a" }, { " ", "\n" } },
+        { "[\\d_]+", { "1_2" }, { "a" } },
+        { "[\\w-]+", { "a-b_c" }, { "a b" } },
+        // Escaped metacharacters and '.'
+        { "\\.", { "." }, { "a" } },
+        { ".", { "a", " ", "\xFF" }, { "\n", "" } },
+        { "\\*\\+\\(\\)\\|", { "*+()|" }, { "" } },
+        { "\\[a\\]", { "[a]" }, { "a" } },
+        // Classes combined with operators
+        { "[a-c]*[xy]", { "x", "abcy", "ccx" }, { "abc", "xy" } },
+        { "([ab]|[0-1])+", { "a0b1" }, { "a2" } },
+    };
+
+    for (const auto& c : cases) {
+        for (NFAConstruction method : { NFAConstruction::Thompson, NFAConstruction::Glushkov }) {
+            DFA dfa = RegexParser::toDFA(RegexParser::toNFA(RegexParser::toPostfix(c.regex), method), TOKEN_IDENTIFIER);
+            for (const auto& s : c.accepted) {
+                if (!CHECK(wholeMatch(dfa, s))) fprintf(stderr, "  %s should match \"%s\"\n", c.regex.c_str(), s.c_str());
+            }
+            for (const auto& s : c.rejected) {
+                if (!CHECK(!wholeMatch(dfa, s))) fprintf(stderr, "  %s should not match \"%s\"\n", c.regex.c_str(), s.c_str());
+            }
+        }
+    }
+
+    // An unterminated '[' is a literal
+    DFA bracket = RegexParser::toDFA(RegexParser::toNFA(RegexParser::toPostfix("a[")), TOKEN_IDENTIFIER);
+    CHECK(wholeMatch(bracket, "a["));
+
+    return Test::result("CharClassTest");
+}
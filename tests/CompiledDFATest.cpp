@@ -0,0 +1,140 @@
+// CompiledDFA gives the same longest match and token as DFA::simulate on the
+// graph it was compiled from, for short inputs and for long runs that take
+// the bulk self-loop path. Byte-class compression keeps every transition of
+// the uncompressed graph and shrinks the table to a few columns.
+
+#include <map>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include "CompiledDFA.h"
+#include "RegexParser.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static DFA build(const std::string& regex, TokenType type) {
+    return RegexParser::toDFA(RegexParser::toNFA(RegexParser::toPostfix(regex)), type);
+}
+
+// Same match length and token from both; -1 when nothing matched
+static bool sameMatch(DFA& dfa, const CompiledDFA& compiled, const std::string& input) {
+    int lastFinal, lastIndex;
+    dfa.simulate(input, lastFinal, lastIndex);
+
+    int32_t compiledFinal;
+    size_t compiledLength;
+    compiled.simulate(input.data(), input.size(), compiledFinal, compiledLength);
+
+    if (lastFinal == -1 || compiledFinal == -1) return lastFinal == -1 && compiledFinal == -1;
+    return (size_t)lastIndex == compiledLength && dfa.stateTokenMap[lastFinal] == compiled.tokenFor(compiledFinal);
+}
+
+// Graph successor of state on byte (-1 = none); byte 0 cannot label a transition
+static int graphNext(const DFA& dfa, int state, unsigned char byte) {
+    if (byte == 0) return -1;
+    for (const auto& t : dfa.states[state].transitions) {
+        if (t.matches((char)byte)) return t.targetStateId;
+    }
+    return -1;
+}
+
+// Walks the graph and the compressed table side by side over all 256 bytes:
+// every graph state must map to one table row with the same token, and a
+// missing transition to the dead row
+static bool sameTransitions(DFA& dfa, const CompiledDFA& compiled) {
+    std::map<int, int32_t> rowOf = { { dfa.startStateId, compiled.getStartState() } };
+    std::queue<int> q;
+    q.push(dfa.startStateId);
+    while (!q.empty()) {
+        int s = q.front(); q.pop();
+        int32_t row = rowOf[s];
+        bool final = dfa.states[s].isFinal;
+        if (final != compiled.isAccepting(row)) return false;
+        if (final && dfa.stateTokenMap[s] != compiled.tokenFor(row)) return false;
+
+        for (int b = 0; b < 256; b++) {
+            int target = graphNext(dfa, s, (unsigned char)b);
+            int32_t targetRow = compiled.next(row, (unsigned char)b);
+            if (target == -1) {
+                if (targetRow != CompiledDFA::DEAD_STATE) return false;
+                continue;
+            }
+            auto it = rowOf.find(target);
+            if (it == rowOf.end()) {
+                rowOf[target] = targetRow;
+                q.push(target);
+            } else if (it->second != targetRow) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    const std::vector<std::string> regexes = {
+        "a", "ab|ac", "a*", "(a|b)*abb", "[0-9]+(\\.[0-9]+)?", "[a-zA-Z_][a-zA-Z0-9_]*",
+        "\"[^\"\\n]*\"", "x{2,4}y", "(ab)+|a+", "[\\x01-\\xFF]+",
+    };
+    const std::string alphabet = "abxy019._\"\n\xC3\xA9\x01\xFF";
+
+    std::mt19937 rng(2);
+    for (const auto& regex : regexes) {
+        DFA dfa = build(regex, TOKEN_IDENTIFIER);
+        CompiledDFA compiled = CompiledDFA::compile(dfa);
+        CHECK(compiled.getStateCount() >= (int)dfa.states.size()); // Plus the dead row
+        CHECK(sameTransitions(dfa, compiled));
+
+        // 1. Short random inputs
+        for (int n = 0; n < 300; n++) {
+            std::string input;
+            size_t length = rng() % 24;
+            for (size_t i = 0; i < length; i++) input += alphabet[rng() % alphabet.size()];
+            CHECK(sameMatch(dfa, compiled, input));
+        }
+
+        // 2. Long runs of one byte, then a different tail
+        for (char c : alphabet) {
+            std::string input(100 + rng() % 100, c);
+            input += alphabet[rng() % alphabet.size()];
+            CHECK(sameMatch(dfa, compiled, input));
+        }
+    }
+
+    // 3. Multi-rule DFA: each accepting state keeps its rule's token
+    NFA combined = RegexParser::combineNFAs({
+        RegexParser::toNFA(RegexParser::toPostfix("if")),
+        RegexParser::toNFA(RegexParser::toPostfix("[a-z]+")),
+        RegexParser::toNFA(RegexParser::toPostfix("[0-9]+")),
+    });
+    DFA multi = RegexParser::toDFA(combined, { TOKEN_KEYWORD, TOKEN_IDENTIFIER, TOKEN_NUMBER });
+    CompiledDFA compiledMulti = CompiledDFA::compile(multi);
+    for (const std::string input : { "if", "iff", "i", "42x", "x42", "", "+" }) {
+        CHECK(sameMatch(multi, compiledMulti, input));
+    }
+    CHECK(sameTransitions(multi, compiledMulti));
+
+    // 4. Class compression: one column per set of bytes that always move together
+    CHECK(CompiledDFA::compile(build("[a-z]+", TOKEN_IDENTIFIER)).getClassCount() == 2);
+    CHECK(CompiledDFA::compile(build("[\\x01-\\xFF]+", TOKEN_IDENTIFIER)).getClassCount() == 2);
+    CompiledDFA identifier = CompiledDFA::compile(build("[a-zA-Z_][a-zA-Z0-9_]*", TOKEN_IDENTIFIER));
+    CHECK(identifier.getClassCount() == 3);
+    CHECK(identifier.getByteClass('a') == identifier.getByteClass('Z') && identifier.getByteClass('a') == identifier.getByteClass('_'));
+    CHECK(identifier.getByteClass('0') != identifier.getByteClass('a') && identifier.getByteClass('0') != identifier.getByteClass(' '));
+    CHECK(identifier.getTableBytes() == (size_t)identifier.getStateCount() * 3 * sizeof(int32_t));
+
+    // 5. Tables taken over by fromTables scan the same
+    CompiledDFA copy = CompiledDFA::fromTables(identifier.getStateCount(), identifier.getClassCount(), identifier.getStartState(),
+                                               identifier.getByteClasses(), identifier.getTable(), identifier.getAcceptTokens());
+    CHECK(CompiledDFA::equivalent(copy, identifier));
+
+    // 6. An empty CompiledDFA matches nothing
+    CompiledDFA empty;
+    int32_t lastFinal;
+    size_t lastLength;
+    CHECK(empty.empty() && empty.simulate("abc", 3, lastFinal, lastLength) == CompiledDFA::DEAD_STATE && lastFinal == -1);
+
+    return Test::result("CompiledDFATest");
+}
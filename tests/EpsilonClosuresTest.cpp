@@ -0,0 +1,89 @@
+// EpsilonClosures gives the same closure for every state whether it
+// precomputes them per SCC or walks them on demand (forced here with a zero
+// byte budget), and both match a plain breadth-first search.
+
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "RegexParser.h"
+#include "StateSet.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static std::set<int> bruteForce(const NFA& nfa, int state) {
+    std::set<int> seen = { state };
+    std::queue<int> q;
+    q.push(state);
+    while (!q.empty()) {
+        int s = q.front(); q.pop();
+        for (const auto& t : nfa.states[s].transitions) {
+            if (t.isEpsilon() && seen.insert(t.targetStateId).second) q.push(t.targetStateId);
+        }
+    }
+    return seen;
+}
+
+static void compare(const NFA& nfa) {
+    EpsilonClosures precomputed(nfa);
+    EpsilonClosures onDemand(nfa, 0);
+    CHECK(precomputed.isPrecomputed());
+    CHECK(!onDemand.isPrecomputed() || nfa.states.empty());
+
+    const int n = (int)nfa.states.size();
+    for (int s = 0; s < n; s++) {
+        std::set<int> expected = bruteForce(nfa, s);
+
+        std::vector<int> walked;
+        onDemand.forEach(s, [&](int u) { walked.push_back(u); });
+        CHECK(walked.size() == expected.size()); // Each state reported once
+        CHECK(std::set<int>(walked.begin(), walked.end()) == expected);
+
+        StateSet a(n), b(n);
+        precomputed.addTo(s, a);
+        onDemand.addTo(s, b);
+        CHECK(a == b);
+        std::set<int> members;
+        a.forEach([&](int u) { members.insert(u); });
+        CHECK(members == expected);
+    }
+}
+
+int main() {
+    // 1. Thompson NFAs: nested stars make epsilon cycles
+    for (const std::string regex : { "a*", "(a*b*)*c", "((a|b)*|c+)*d?", "(a?b?)*(c|)+", "x" }) {
+        compare(RegexParser::toNFA(RegexParser::toPostfix(regex)));
+    }
+
+    // 2. Random graphs, epsilon edges only and mixed
+    std::mt19937 rng(5);
+    for (int round = 0; round < 40; round++) {
+        NFA nfa;
+        int n = 1 + (int)(rng() % 60);
+        for (int s = 0; s < n; s++) nfa.states.push_back({ s, false, {}, {} });
+        int edges = (int)(rng() % (2 * n + 1));
+        for (int e = 0; e < edges; e++) {
+            char input = (rng() % 3) ? '\0' : 'a';
+            nfa.states[rng() % n].transitions.push_back({ input, (int)(rng() % n) });
+        }
+        nfa.startStateId = 0;
+        nfa.finalStateId = n - 1;
+        compare(nfa);
+    }
+
+    // 3. toDFA over the cap: a{12000} as Thompson fragments has ~2N
+    // epsilon-linked states, too many to precompute, and still determinizes to
+    // N + 1 states (nested, since one repeat count is at most 1000)
+    const int N = 12000;
+    NFA big = RegexParser::toNFA(RegexParser::toPostfix("(a{1000}){12}"));
+    CHECK(!EpsilonClosures(big).isPrecomputed());
+    DFA dfa = RegexParser::toDFA(big, TOKEN_IDENTIFIER);
+    CHECK((int)dfa.states.size() == N + 1);
+    int finals = 0;
+    for (const auto& st : dfa.states) finals += st.isFinal ? 1 : 0;
+    CHECK(finals == 1);
+
+    return Test::result("EpsilonClosuresTest");
+}
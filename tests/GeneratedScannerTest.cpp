@@ -0,0 +1,65 @@
+// The generated scanner (ScannerGen) must produce exactly the token stream of
+// Lexer::tokenizeSpans with the default rules, including UNKNOWN tokens for
+// non-ASCII and invalid bytes, line numbers and the final EOF.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "GeneratedScanner.h"
+#include "Lexer.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static bool sameTokens(const std::vector<TokenSpan>& a, const std::vector<TokenSpan>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].type != b[i].type || a[i].offset != b[i].offset || a[i].length != b[i].length || a[i].line != b[i].line) return false;
+    }
+    return true;
+}
+
+int main() {
+    Lexer lexer;
+    lexer.init();
+
+    std::vector<std::string> corpus = {
+        "",
+        "x = 42",
+        "count = (a + b) * 3 / { y - 7 }\n\tvalue_1 = count\r\n",
+        std::string(200, 'a') + " " + std::string(200, '9') + "\n" + std::string(100, '_'),
+        "caf\xC3\xA9 = \xE2\x82\xAC" "5 + \xF0\x9F\x98\x80\n",        // Valid UTF-8
+        "a \xC3 b \xE2\x82 c \xED\xA0\x80 d \xC0\x80 e \xFF\xFE",      // Truncated, surrogate, overlong, invalid
+        "tail \xE2\x82",                                              // Truncated at the end
+    };
+
+    // Random bytes, and random mixes of tokens, spaces and non-ASCII
+    std::mt19937 rng(9);
+    const char* pieces[] = { "id", "x1", "_", "123", "+", "-", "*", "/", "=", "(", ")", "{", "}", " ", "\n", "\t",
+                             "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\x80", "\xFF", "#", "\"" };
+    for (int n = 0; n < 200; n++) {
+        std::string bytes, mix;
+        size_t length = rng() % 300;
+        for (size_t i = 0; i < length; i++) bytes += (char)(rng() & 0xFF);
+        for (size_t i = 0; i < length; i++) mix += pieces[rng() % (sizeof(pieces) / sizeof(pieces[0]))];
+        corpus.push_back(bytes);
+        corpus.push_back(mix);
+    }
+
+    for (const std::string& input : corpus) {
+        if (!CHECK(sameTokens(GeneratedScanner::tokenize(input), lexer.tokenizeSpans(input)))) {
+            fprintf(stderr, "  input of %zu bytes differs\n", input.size());
+        }
+    }
+
+    // matchToken agrees too, at every offset of one mixed input
+    const std::string& sample = corpus[corpus.size() - 1];
+    for (size_t i = 0; i < sample.size(); i++) {
+        TokenType generatedType = TOKEN_INVALID, lexerType = TOKEN_INVALID;
+        size_t generated = GeneratedScanner::matchToken(sample.data() + i, sample.size() - i, generatedType);
+        size_t expected = lexer.matchToken(sample.data() + i, sample.size() - i, lexerType);
+        CHECK(generated == expected && (expected == 0 || generatedType == lexerType));
+    }
+
+    return Test::result("GeneratedScannerTest");
+}
@@ -0,0 +1,67 @@
+// Glushkov and Thompson NFAs of the same regex accept the same language:
+// their determinized DFAs are equivalent. The Glushkov NFA has no epsilon
+// transitions and one state per symbol occurrence plus the start state.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "CompiledDFA.h"
+#include "RegexParser.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static CompiledDFA compiled(const std::string& regex, NFAConstruction method) {
+    return CompiledDFA::compile(RegexParser::toDFA(RegexParser::toNFA(RegexParser::toPostfix(regex), method), TOKEN_IDENTIFIER));
+}
+
+static bool epsilonFree(const NFA& nfa) {
+    for (const auto& s : nfa.states) {
+        for (const auto& t : s.transitions) {
+            if (t.isEpsilon()) return false;
+        }
+    }
+    return true;
+}
+
+static std::string randomRegex(std::mt19937& rng, int depth) {
+    int pick = depth <= 0 ? (int)(rng() % 4) : (int)(rng() % 10);
+    switch (pick) {
+        case 0: return std::string(1, "abc"[rng() % 3]);
+        case 1: return "[b-c]";
+        case 2: return "[^a]";
+        case 3: return "\\d";
+        case 4: case 5: return randomRegex(rng, depth - 1) + randomRegex(rng, depth - 1);
+        case 6: return "(" + randomRegex(rng, depth - 1) + "|" + randomRegex(rng, depth - 1) + ")";
+        case 7: return "(" + randomRegex(rng, depth - 1) + ")*";
+        case 8: return "(" + randomRegex(rng, depth - 1) + ")+";
+        default: return "(" + randomRegex(rng, depth - 1) + "){0,2}";
+    }
+}
+
+int main() {
+    std::vector<std::string> regexes = {
+        "a", "ab", "a|b", "a*", "a+", "(a|b)*abb", "(a*b*)*", "(a|)+", "((a|b)*|c+)*d?", "[0-9]+(\\.[0-9]+)?",
+        "x{3}", "x{2,}", "x{0,3}y", "(ab){2,3}", "\\w+|\\s+", "[^\\n]*", "(a|ab)(c|bcd)(d*)",
+    };
+    std::mt19937 rng(18);
+    for (int i = 0; i < 200; i++) regexes.push_back(randomRegex(rng, 4));
+
+    for (const auto& regex : regexes) {
+        NFA glushkov = RegexParser::toNFA(RegexParser::toPostfix(regex), NFAConstruction::Glushkov);
+        CHECK(epsilonFree(glushkov));
+        if (!CHECK(CompiledDFA::equivalent(compiled(regex, NFAConstruction::Thompson), compiled(regex, NFAConstruction::Glushkov)))) {
+            fprintf(stderr, "  languages differ for %s\n", regex.c_str());
+        }
+    }
+
+    // One state per symbol occurrence, plus the start
+    CHECK(RegexParser::toNFA(RegexParser::toPostfix("(a|b)*abb"), NFAConstruction::Glushkov).states.size() == 6);
+    CHECK(RegexParser::toNFA(RegexParser::toPostfix("[a-z][a-z0-9]*"), NFAConstruction::Glushkov).states.size() == 3);
+
+    // Different languages are told apart
+    CHECK(!CompiledDFA::equivalent(compiled("a*", NFAConstruction::Thompson), compiled("a+", NFAConstruction::Glushkov)));
+
+    return Test::result("GlushkovTest");
+}
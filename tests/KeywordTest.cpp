@@ -0,0 +1,94 @@
+// Keywords beat rule matches of the same length ("if" is a keyword, "iffy" an
+// identifier) and shorter ones ("==" over "="). tokenizeSpans must agree with
+// a reference scan, and tokenizeParallel and StreamLexer with tokenizeSpans.
+
+#include <cctype>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Lexer.h"
+#include "StreamLexer.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static bool sameTokens(const std::vector<TokenSpan>& a, const std::vector<TokenSpan>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].type != b[i].type || a[i].offset != b[i].offset || a[i].length != b[i].length || a[i].line != b[i].line) return false;
+    }
+    return true;
+}
+
+int main() {
+    const std::vector<std::string> keywords = { "if", "else", "while", "for", "return", "==", "!=", "<=", "<<=", "->", "+=" };
+
+    Lexer plain;
+    plain.init();
+    Lexer lexer;
+    lexer.init();
+    for (const auto& k : keywords) lexer.addKeyword(k, isalpha((unsigned char)k[0]) ? TOKEN_KEYWORD : TOKEN_OPERATOR_EQ);
+
+    // 1. Ties and prefixes
+    std::vector<TokenSpan> small = lexer.tokenizeSpans("if iffy if_ for4 while = == <<= <");
+    std::vector<TokenType> types;
+    for (const auto& t : small) types.push_back(t.type);
+    CHECK((types == std::vector<TokenType>{ TOKEN_KEYWORD, TOKEN_IDENTIFIER, TOKEN_IDENTIFIER, TOKEN_IDENTIFIER, TOKEN_KEYWORD,
+                                            TOKEN_OPERATOR_EQ, TOKEN_OPERATOR_EQ, TOKEN_OPERATOR_EQ, TOKEN_UNKNOWN, TOKEN_EOF }));
+    CHECK(small[6].length == 2 && small[7].length == 3);
+
+    // 2. Random text against a reference scan: rule match vs longest keyword
+    std::mt19937 rng(5);
+    const char* pieces[] = { "if", "iff", "iffy", "else", "x", "==", "=", "<", "<=", "<<=", "!", "!=", "12", " ", "\n",
+                             "+=", "+", "->", "-", "(", ")", "while_", "for", "fory", "ret", "return" };
+    std::string text;
+    while (text.size() < 600 * 1024) {
+        text += pieces[rng() % (sizeof(pieces) / sizeof(pieces[0]))];
+        if (rng() % 3 == 0) text += ' ';
+    }
+    std::vector<TokenSpan> tokens = lexer.tokenizeSpans(text);
+
+    size_t cursor = 0, index = 0;
+    while (cursor < text.size()) {
+        if (isspace((unsigned char)text[cursor])) { cursor++; continue; }
+        TokenType type = TOKEN_INVALID;
+        size_t length = plain.matchToken(text.data() + cursor, text.size() - cursor, type);
+        size_t keyword = 0;
+        TokenType keywordType = TOKEN_INVALID;
+        for (const auto& k : keywords) {
+            if (k.size() > keyword && text.compare(cursor, k.size(), k) == 0) {
+                keyword = k.size();
+                keywordType = isalpha((unsigned char)k[0]) ? TOKEN_KEYWORD : TOKEN_OPERATOR_EQ;
+            }
+        }
+        if (keyword > 0 && keyword >= length) { length = keyword; type = keywordType; }
+        if (length == 0) { length = 1; type = TOKEN_UNKNOWN; }
+
+        if (!CHECK(index < tokens.size() && tokens[index].offset == cursor && tokens[index].length == length && tokens[index].type == type)) break;
+        index++;
+        cursor += length;
+    }
+    CHECK(index + 1 == tokens.size());
+
+    // 3. Parallel and streaming
+    CHECK(sameTokens(lexer.tokenizeParallel(text, 4), tokens));
+    for (size_t chunk : { 1, 2, 3, 7, 4096 }) {
+        std::vector<TokenSpan> streamed;
+        StreamLexer stream(lexer, [&](const TokenSpan& t, std::string_view) { streamed.push_back(t); });
+        for (size_t p = 0; p < text.size(); p += chunk) stream.feed(text.data() + p, std::min(chunk, text.size() - p));
+        stream.finish();
+        if (!CHECK(sameTokens(streamed, tokens))) fprintf(stderr, "  stream with %zu-byte chunks differs\n", chunk);
+    }
+
+    // 4. Invalid words
+    bool threw = false;
+    try {
+        lexer.addKeyword("");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    return Test::result("KeywordTest");
+}
@@ -0,0 +1,157 @@
+// A LexerImage saved by one Lexer and loaded by another gives the same tokens,
+// and its scanner outlives the image. Truncated, foreign or corrupted files
+// are rejected, and a failed loadTables leaves the lexer as it was.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "Lexer.h"
+#include "LexerImage.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static bool sameTokens(const std::vector<TokenSpan>& a, const std::vector<TokenSpan>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].type != b[i].type || a[i].offset != b[i].offset || a[i].length != b[i].length || a[i].line != b[i].line) return false;
+    }
+    return true;
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), (std::streamsize)bytes.size());
+}
+
+// Header fields used below (see the Header struct in LexerImage.cpp)
+static const size_t VERSION_OFFSET = 8;
+static const size_t BYTE_CLASS_OFFSET_FIELD = 56;
+static const size_t TABLE_OFFSET_FIELD = 64;
+static const size_t ACCEPT_OFFSET_FIELD = 72;
+static const size_t SELF_LOOP_OFFSET_FIELD = 80;
+static const size_t RULE_OFFSET_FIELD = 88;
+
+// Copy of image with the int32 at the start of the section named by field
+// (the first transition, accept token, self-loop count or rule type) replaced
+static std::string patchSection(const std::string& image, size_t field, int32_t value) {
+    std::string patched = image;
+    uint64_t offset;
+    std::memcpy(&offset, &image[field], sizeof(offset));
+    std::memcpy(&patched[offset], &value, sizeof(value));
+    return patched;
+}
+
+int main() {
+    const std::string path = "LexerImageTest.dfa";
+    const std::string damaged = "LexerImageTest.bad.dfa";
+
+    Lexer source;
+    source.init();
+    source.addKeyword("while");
+    source.addKeyword("return");
+    source.addKeyword("==", TOKEN_OPERATOR_EQ);
+
+    std::string text = "while (x == 10) { return y + 3.5e2; } // done\n\"\xC3\xA9t\xC3\xA9\" \xFF\x80 iffy";
+    std::mt19937 rng(11);
+    for (int i = 0; i < 20000; i++) text += (char)(rng() % 3 ? " abc1=+(){};\n\"."[rng() % 16] : rng() % 256);
+
+    // 1. Round trip: same tokens, same scanner
+    CHECK(source.saveTables(path));
+    Lexer loaded;
+    CHECK(loaded.loadTables(path));
+    std::vector<TokenSpan> expected = source.tokenizeSpans(text);
+    CHECK(sameTokens(loaded.tokenizeSpans(text), expected));
+    CHECK(CompiledDFA::equivalent(loaded.getScanner(), source.getScanner()));
+
+    // 2. Rules and keywords come back
+    LexerImage image;
+    CHECK(image.open(path) && image.getError().empty());
+    std::set<std::string> words;
+    size_t ruleCount = 0;
+    for (const auto& rule : image.getRules()) {
+        if (rule.keyword) words.insert(std::string(rule.regex));
+        else ruleCount++;
+    }
+    CHECK((words == std::set<std::string>{ "while", "return", "==" }));
+    CHECK(ruleCount > 0);
+
+    // 3. The scanner keeps the mapping alive after the image is gone
+    CompiledDFA kept;
+    {
+        LexerImage scoped;
+        CHECK(scoped.open(path, false));
+        kept = scoped.getScanner();
+    }
+    CHECK(CompiledDFA::equivalent(kept, source.getScanner()));
+
+    // 4. Damaged files are rejected, with and without verify
+    const std::string good = readFile(path);
+    CHECK(good.size() > 200);
+
+    auto rejected = [&](const std::string& bytes, bool verify) {
+        writeFile(damaged, bytes);
+        LexerImage bad;
+        bool opened = bad.open(damaged, verify);
+        return !opened && !bad.getError().empty() && bad.getScanner().empty() && bad.getRules().empty();
+    };
+
+    CHECK(rejected("", true));
+    CHECK(rejected(good.substr(0, 50), false));
+    CHECK(rejected(good.substr(0, good.size() - 1), false));
+    CHECK(rejected(good + '\0', false));
+
+    std::string badMagic = good;
+    badMagic[0] = 'X';
+    CHECK(rejected(badMagic, false));
+
+    std::string badVersion = good;
+    uint32_t version = LexerImage::VERSION + 1;
+    std::memcpy(&badVersion[VERSION_OFFSET], &version, sizeof(version));
+    CHECK(rejected(badVersion, false));
+
+    std::string badClass = good;
+    uint64_t byteClassOffset;
+    std::memcpy(&byteClassOffset, &good[BYTE_CLASS_OFFSET_FIELD], sizeof(byteClassOffset));
+    badClass[byteClassOffset + 'a'] = (char)0xFF;
+    CHECK(rejected(badClass, false));
+
+    // Values the scanner indexes with are checked even without verify
+    CHECK(rejected(patchSection(good, TABLE_OFFSET_FIELD, 1 << 30), false));
+    CHECK(rejected(patchSection(good, TABLE_OFFSET_FIELD, -2), false));
+    CHECK(rejected(patchSection(good, ACCEPT_OFFSET_FIELD, 1000), false));
+    CHECK(rejected(patchSection(good, ACCEPT_OFFSET_FIELD, -2), false));
+    CHECK(rejected(patchSection(good, SELF_LOOP_OFFSET_FIELD, 1000), false));
+    CHECK(rejected(patchSection(good, RULE_OFFSET_FIELD, 1000), false));
+
+    std::string badChecksum = good;
+    badChecksum.back() ^= 0x20; // Last byte of the rule text
+    CHECK(rejected(badChecksum, true));
+    writeFile(damaged, badChecksum);
+    LexerImage trusted;
+    CHECK(trusted.open(damaged, false)); // Not verified: the rule text is not checked
+
+    // 5. A failed load leaves the lexer unchanged
+    Lexer target;
+    target.addRule("[a-z]+", TOKEN_IDENTIFIER);
+    target.addKeyword("abc");
+    std::vector<TokenSpan> before = target.tokenizeSpans(text);
+    CHECK(!target.loadTables(damaged));
+    CHECK(!target.loadTables("LexerImageTest.missing.dfa"));
+    CHECK(sameTokens(target.tokenizeSpans(text), before));
+    CHECK(!sameTokens(before, expected));
+
+    std::remove(path.c_str());
+    std::remove(damaged.c_str());
+    return Test::result("LexerImageTest");
+}
@@ -0,0 +1,83 @@
+// Required-literal extraction (RegexParser::extractLiterals) must be sound:
+// every match of the regex starts with one of its prefixes and contains one
+// of its factors. RegexSearch then picks its prefilter from them.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "CompiledDFA.h"
+#include "RegexParser.h"
+#include "RegexSearch.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static std::mt19937 rng(11);
+
+static std::string randomRegex(int depth) {
+    static const char* atoms[] = { "a", "b", "c", "ab", "abc", "[a-c]", "[^a]", "\\d", "\\w", ".", "1", "_",
+                                   "[ab]{2}", "a{1,3}", "b{0}", "(ab){0,2}", "c{2,}", "(ca){3}", "x", "[xy]" };
+    switch (rng() % (depth > 3 ? 2 : 7)) {
+    case 0:
+    case 1: return atoms[rng() % (sizeof(atoms) / sizeof(atoms[0]))];
+    case 2:
+    case 3: return randomRegex(depth + 1) + randomRegex(depth + 1);
+    case 4: return "(" + randomRegex(depth + 1) + "|" + randomRegex(depth + 1) + ")";
+    case 5: return "(" + randomRegex(depth + 1) + ")*";
+    default: return "(" + randomRegex(depth + 1) + ")+";
+    }
+}
+
+static bool startsWithAny(const std::string& s, const std::vector<std::string>& literals) {
+    for (const auto& l : literals) if (s.compare(0, l.size(), l) == 0) return true;
+    return literals.empty();
+}
+
+static bool containsAny(const std::string& s, const std::vector<std::string>& literals) {
+    for (const auto& l : literals) if (s.find(l) != std::string::npos) return true;
+    return literals.empty();
+}
+
+int main() {
+    const char alphabet[] = "abc1_xy\n ";
+
+    // 1. Soundness on random regexes: every matching prefix of random text
+    for (int n = 0; n < 2000; n++) {
+        std::string regex = randomRegex(0);
+        RegexLiterals literals = RegexParser::extractLiterals(regex);
+        CompiledDFA dfa = CompiledDFA::compile(*RegexParser::createDFA(regex, TOKEN_UNKNOWN));
+        CHECK((int)literals.prefixes.size() <= RegexParser::MAX_LITERALS && (int)literals.factors.size() <= RegexParser::MAX_LITERALS);
+        CHECK(literals.nullable == dfa.isAccepting(dfa.getStartState()));
+
+        for (int k = 0; k < 30; k++) {
+            std::string text;
+            int length = rng() % 30;
+            for (int i = 0; i < length; i++) text += alphabet[rng() % (sizeof(alphabet) - 1)];
+
+            // Every accepting prefix is a match
+            int32_t state = dfa.getStartState();
+            for (size_t i = 0; i <= text.size() && state != CompiledDFA::DEAD_STATE; i++) {
+                if (dfa.isAccepting(state)) {
+                    std::string match = text.substr(0, i);
+                    if (!CHECK(startsWithAny(match, literals.prefixes) && containsAny(match, literals.factors))) {
+                        fprintf(stderr, "  regex %s, match \"%s\"\n", regex.c_str(), match.c_str());
+                    }
+                }
+                if (i < text.size()) state = dfa.next(state, (unsigned char)text[i]);
+            }
+        }
+    }
+
+    // 2. Known literals and the prefilter chosen from them
+    RegexLiterals methods = RegexParser::extractLiterals("(GET|POST) /index");
+    CHECK((methods.prefixes == std::vector<std::string>{ "GET /index", "POST /index" }));
+    CHECK(RegexParser::extractLiterals("[0-9]+ms").factors == std::vector<std::string>{ "ms" });
+    CHECK(RegexParser::extractLiterals("a*").nullable);
+
+    CHECK(RegexSearch("timeout=[0-9]+").getPrefilter() == RegexSearch::Prefilter::Prefix);
+    CHECK(RegexSearch("\\w+@\\w+\\.com").getPrefilter() == RegexSearch::Prefilter::Factor);
+    CHECK(RegexSearch("[a-z]+").getPrefilter() == RegexSearch::Prefilter::StartBytes);
+    CHECK(RegexSearch("a*").getPrefilter() == RegexSearch::Prefilter::None);
+
+    return Test::result("LiteralsTest");
+}
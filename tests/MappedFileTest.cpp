@@ -0,0 +1,76 @@
+// tokenizeFile / MappedFile: a mapped file tokenizes like the same bytes in
+// memory, an empty file is an empty view with just TOKEN_EOF, and a missing
+// file (or a directory) fails without leaving a mapping open.
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Lexer.h"
+#include "MappedFile.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), (std::streamsize)bytes.size());
+}
+
+int main() {
+    const std::string path = "MappedFileTest.txt";
+    const std::string emptyPath = "MappedFileTest.empty.txt";
+
+    Lexer lexer;
+    lexer.init();
+
+    // 1. A file tokenizes like its contents; spans refer into the mapping
+    std::string text;
+    for (int i = 0; i < 5000; i++) text += "x" + std::to_string(i) + " = (y + " + std::to_string(i * 7) + ")\n";
+    writeFile(path, text);
+
+    MappedFile mapping;
+    std::vector<TokenSpan> tokens;
+    CHECK(lexer.tokenizeFile(path, mapping, tokens));
+    CHECK(mapping.isOpen() && mapping.size() == text.size() && mapping.view() == text);
+    std::vector<TokenSpan> expected = lexer.tokenizeSpans(text);
+    bool same = tokens.size() == expected.size();
+    for (size_t i = 0; same && i < tokens.size(); i++) {
+        same = tokens[i].type == expected[i].type && tokens[i].offset == expected[i].offset &&
+               tokens[i].length == expected[i].length && tokens[i].line == expected[i].line;
+    }
+    CHECK(same);
+    CHECK(tokens.size() > 1 && mapping.view().substr(tokens[0].offset, tokens[0].length) == "x0");
+
+    // 2. Moving the mapping keeps the view; closing drops it
+    MappedFile moved(std::move(mapping));
+    CHECK(moved.isOpen() && moved.view() == text && !mapping.isOpen());
+    moved.close();
+    CHECK(!moved.isOpen() && moved.size() == 0);
+
+    // 3. Empty file: opens as an empty view, only TOKEN_EOF
+    writeFile(emptyPath, "");
+    MappedFile empty;
+    CHECK(lexer.tokenizeFile(emptyPath, empty, tokens));
+    CHECK(empty.isOpen() && empty.size() == 0 && empty.view().empty());
+    CHECK(tokens.size() == 1 && tokens[0].type == TOKEN_EOF && tokens[0].offset == 0 && tokens[0].line == 1);
+
+    // 4. Missing file and directory: false, nothing open, tokens untouched
+    MappedFile missing;
+    tokens = { { TOKEN_NUMBER, 0, 1, 1 } };
+    CHECK(!lexer.tokenizeFile("MappedFileTest.missing.txt", missing, tokens));
+    CHECK(!missing.isOpen() && missing.data() == nullptr);
+    CHECK(tokens.size() == 1 && tokens[0].type == TOKEN_NUMBER);
+    CHECK(!missing.open("."));
+    CHECK(!missing.isOpen());
+
+    // 5. A failed open closes the previous mapping
+    MappedFile reused;
+    CHECK(reused.open(path) && reused.size() == text.size());
+    CHECK(!reused.open("MappedFileTest.missing.txt") && !reused.isOpen() && reused.size() == 0);
+
+    std::remove(path.c_str());
+    std::remove(emptyPath.c_str());
+    return Test::result("MappedFileTest");
+}
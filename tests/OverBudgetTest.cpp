@@ -0,0 +1,68 @@
+// Rule sets over RegexParser::MAX_DFA_STATES: the Lexer runs them on a lazy
+// DFA (falling back to the Pike VM if its cache thrashes). Both must give the
+// same longest matches as the Pike VM on the same combined NFA.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "Lexer.h"
+#include "LazyDFA.h"
+#include "PikeVM.h"
+#include "RegexParser.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+int main() {
+    const std::vector<std::pair<std::string, TokenType>> rules = {
+        { "(a|b)*a(a|b){20}", TOKEN_IDENTIFIER },
+        { "[ab]+", TOKEN_NUMBER },
+        { "c", TOKEN_OPERATOR_PLUS },
+    };
+
+    Lexer lexer;
+    std::vector<NFA> nfas;
+    std::vector<TokenType> types;
+    for (const auto& [regex, type] : rules) {
+        lexer.addRule(regex, type);
+        nfas.push_back(RegexParser::toNFA(RegexParser::toPostfix(regex), NFAConstruction::Glushkov));
+        types.push_back(type);
+    }
+    NFA combined = RegexParser::combineNFAs(nfas);
+    PikeVM reference(combined, types);
+    LazyDFA lazy(combined, types, LazyDFA::MIN_CACHE_BYTES); // Small cache: flushes often
+
+    // 1. The rules really are over budget
+    CHECK(lexer.getCombinedDFA().states.empty());
+
+    // 2. Lazy DFA == Pike VM on random inputs, including across cache flushes
+    std::mt19937 rng(3);
+    for (int n = 0; n < 300; n++) {
+        std::string input;
+        size_t length = rng() % 200;
+        for (size_t i = 0; i < length; i++) input += "abc "[rng() % ((n % 3) ? 2 : 4)];
+
+        TokenType lazyType = TOKEN_INVALID, vmType = TOKEN_INVALID;
+        size_t lazyIndex = NO_MATCH, vmIndex = NO_MATCH;
+        bool lazyAlive = lazy.simulate(input, lazyType, lazyIndex);
+        bool vmAlive = reference.simulate(input, vmType, vmIndex);
+        CHECK(lazyAlive == vmAlive && lazyIndex == vmIndex && (lazyIndex == NO_MATCH || lazyIndex == 0 || lazyType == vmType));
+    }
+    CHECK(lazy.getFlushCount() > 0);
+
+    // 3. The Lexer's tokens follow the same matches
+    std::string text;
+    for (int i = 0; i < 20000; i++) text += "ab c\n"[rng() % 5];
+    std::vector<TokenSpan> tokens = lexer.tokenizeSpans(text);
+    CHECK(!tokens.empty() && tokens.back().type == TOKEN_EOF);
+    for (const TokenSpan& t : tokens) {
+        if (t.type == TOKEN_EOF || t.type == TOKEN_UNKNOWN) continue;
+        TokenType vmType = TOKEN_INVALID;
+        size_t vmIndex = NO_MATCH;
+        reference.simulate(text.data() + t.offset, text.size() - t.offset, vmType, vmIndex);
+        if (!CHECK(vmIndex == t.length && vmType == t.type)) break;
+    }
+    CHECK(lexer.tokenizeParallel(text, 4).size() == tokens.size());
+
+    return Test::result("OverBudgetTest");
+}
@@ -0,0 +1,85 @@
+// The Pike VM gives the same anchored longest match and token as the DFA
+// determinized from the same NFA, for single rules (Thompson and Glushkov)
+// and combined rule sets where the earliest rule wins ties.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "PikeVM.h"
+#include "RegexParser.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+// True if the DFA walk is still in some state after all of input
+static bool dfaAlive(const DFA& dfa, const std::string& input) {
+    int state = dfa.startStateId;
+    for (char c : input) {
+        int next = -1;
+        for (const auto& t : dfa.states[state].transitions) {
+            if (t.matches(c)) { next = t.targetStateId; break; }
+        }
+        if (next == -1) return false;
+        state = next;
+    }
+    return true;
+}
+
+static bool sameMatch(PikeVM& vm, DFA& dfa, const std::string& input) {
+    TokenType vmType = TOKEN_INVALID;
+    size_t vmIndex = NO_MATCH;
+    bool vmAlive = vm.simulate(input, vmType, vmIndex);
+
+    int lastFinal, lastIndex;
+    dfa.simulate(input, lastFinal, lastIndex);
+
+    if (vmIndex != (lastIndex < 0 ? NO_MATCH : (size_t)lastIndex) || vmAlive != dfaAlive(dfa, input)) return false;
+    return lastIndex < 0 || vmType == dfa.stateTokenMap[lastFinal];
+}
+
+static std::string randomInput(std::mt19937& rng, const std::string& alphabet, size_t maxLength) {
+    std::string input;
+    size_t length = rng() % (maxLength + 1);
+    for (size_t i = 0; i < length; i++) input += alphabet[rng() % alphabet.size()];
+    return input;
+}
+
+int main() {
+    const std::vector<std::string> regexes = {
+        "a", "a*", "(a|b)*abb", "(a|ab)(c|bcd)", "(a*)*b", "[0-9]+(\\.[0-9]+)?", "x{2,4}", "(ab|a)*b?",
+        "[^\\n]*\\n", "(a|b)*a(a|b){5}", "\\w+@\\w+", "(|a)+b",
+    };
+    const std::string alphabet = "ab cdx09.\n@_";
+    std::mt19937 rng(17);
+
+    // 1. Single rules
+    for (const auto& regex : regexes) {
+        for (NFAConstruction method : { NFAConstruction::Thompson, NFAConstruction::Glushkov }) {
+            NFA nfa = RegexParser::toNFA(RegexParser::toPostfix(regex), method);
+            DFA dfa = RegexParser::toDFA(nfa, TOKEN_NUMBER);
+            PikeVM vm(nfa, TOKEN_NUMBER);
+            CHECK(!vm.empty());
+            for (int n = 0; n < 200; n++) CHECK(sameMatch(vm, dfa, randomInput(rng, alphabet, 20)));
+        }
+    }
+
+    // 2. Combined rules: ties go to the earlier rule
+    std::vector<NFA> nfas;
+    for (const std::string regex : { "if|else", "[a-z]+", "[0-9]+", "[0-9]+\\.[0-9]*", "=|==" }) {
+        nfas.push_back(RegexParser::toNFA(RegexParser::toPostfix(regex)));
+    }
+    std::vector<TokenType> ruleTypes = { TOKEN_KEYWORD, TOKEN_IDENTIFIER, TOKEN_NUMBER, TOKEN_NUMBER, TOKEN_OPERATOR_EQ };
+    NFA combined = RegexParser::combineNFAs(nfas);
+    DFA dfa = RegexParser::toDFA(combined, ruleTypes);
+    PikeVM vm(combined, ruleTypes);
+    for (const std::string input : { "if", "iff", "else", "12.5", "12.", "==", "=", "" }) CHECK(sameMatch(vm, dfa, input));
+    for (int n = 0; n < 500; n++) CHECK(sameMatch(vm, dfa, randomInput(rng, "iflse09.= ", 12)));
+
+    // 3. A default-constructed VM matches nothing
+    PikeVM none;
+    TokenType type;
+    size_t index;
+    CHECK(none.empty() && !none.simulate("a", type, index) && index == NO_MATCH);
+
+    return Test::result("PikeVMTest");
+}
@@ -0,0 +1,108 @@
+// RegexCache: hit/miss accounting, least-recently-used eviction by count and
+// by size, failed compiles not cached, and consistent stats under threads.
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RegexCache.h"
+#include "RegexParser.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static int compiles = 0;
+
+static CompiledRegex compileRegex(const std::string& regex) {
+    compiles++;
+    CompiledRegex compiled;
+    compiled.dfa = *RegexParser::createDFA(regex, TOKEN_IDENTIFIER);
+    return compiled;
+}
+
+static RegexCache::Entry get(RegexCache& cache, const std::string& regex) {
+    return cache.getOrCompile({ regex, 0, TOKEN_IDENTIFIER }, [&]() { return compileRegex(regex); });
+}
+
+int main() {
+    // 1. Hits, misses and key parts
+    RegexCache cache(2, RegexCache::DEFAULT_MAX_BYTES);
+    RegexCache::Entry a = get(cache, "a+");
+    CHECK(get(cache, "a+") == a);
+    CHECK(compiles == 1);
+    CHECK(cache.getOrCompile({ "a+", RegexCache::GLUSHKOV, TOKEN_IDENTIFIER }, [] { return compileRegex("a+"); }) != a);
+    CHECK(cache.getOrCompile({ "a+", 0, TOKEN_NUMBER }, [] { return compileRegex("a+"); }) != a);
+    RegexCache::Stats stats = cache.getStats();
+    CHECK(stats.hits == 1 && stats.misses == 3 && stats.entries == 2 && stats.evictions == 1);
+
+    // 2. LRU order: touching x keeps it, y goes
+    cache.clear();
+    get(cache, "x");
+    get(cache, "y");
+    get(cache, "x");
+    get(cache, "z");
+    CHECK(cache.find({ "x", 0, TOKEN_IDENTIFIER }) != nullptr);
+    CHECK(cache.find({ "y", 0, TOKEN_IDENTIFIER }) == nullptr);
+    CHECK(cache.find({ "z", 0, TOKEN_IDENTIFIER }) != nullptr);
+
+    // 3. Entries outlive eviction while still referenced
+    RegexCache::Entry held = cache.find({ "x", 0, TOKEN_IDENTIFIER });
+    cache.setLimits(0, 0);
+    CHECK(cache.getStats().entries == 0 && cache.getStats().bytes == 0);
+    CHECK(held && !held->dfa.states.empty());
+
+    // 4. Byte budget: evicts old entries, never stores one larger than the budget
+    RegexCache sized(100, 1);
+    CHECK(get(sized, "abc") != nullptr);
+    CHECK(sized.getStats().entries == 0);
+    size_t bytes = compileRegex("abc").approxBytes() + 3;
+    sized.setLimits(100, bytes * 2 + 1);
+    get(sized, "abd");
+    get(sized, "abe");
+    get(sized, "abf");
+    stats = sized.getStats();
+    CHECK(stats.entries == 2 && stats.bytes <= bytes * 2 + 1 && stats.evictions >= 1);
+
+    // 5. A failing compile stores nothing and is retried
+    RegexCache failing;
+    bool threw = false;
+    try {
+        get(failing, "x{1000}{1000}");
+    } catch (const std::length_error&) {
+        threw = true;
+    }
+    CHECK(threw && failing.getStats().entries == 0);
+
+    // 6. Threads: every lookup is a hit or a miss, entries stay within the limit
+    RegexCache shared(64, RegexCache::DEFAULT_MAX_BYTES);
+    std::atomic<int> lookups{ 0 };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; t++) {
+        workers.emplace_back([&, t]() {
+            for (int k = 0; k < 500; k++) {
+                std::string regex = "[a-z]" + std::to_string((k * 7 + t) % 100);
+                RegexCache::Entry e = shared.getOrCompile({ regex, 0, TOKEN_IDENTIFIER }, [&]() {
+                    CompiledRegex compiled;
+                    compiled.dfa = RegexParser::toDFA(RegexParser::toNFA(RegexParser::toPostfix(regex)), TOKEN_IDENTIFIER);
+                    return compiled;
+                });
+                if (e && !e->dfa.states.empty()) lookups++;
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    stats = shared.getStats();
+    CHECK(lookups == 4000);
+    CHECK(stats.hits + stats.misses == 4000);
+    CHECK(stats.entries <= 64 && stats.entries + stats.evictions <= stats.misses);
+
+    // 7. createDFA hits share the cached DFA instead of copying it, and it
+    // stays valid after the global cache drops the entry
+    std::shared_ptr<const DFA> first = RegexParser::createDFA("(a|b)*abb", TOKEN_IDENTIFIER);
+    CHECK(RegexParser::createDFA("(a|b)*abb", TOKEN_IDENTIFIER) == first);
+    RegexCache::global().clear();
+    CHECK(!first->states.empty() && RegexParser::createDFA("(a|b)*abb", TOKEN_IDENTIFIER) != first);
+
+    return Test::result("RegexCacheTest");
+}
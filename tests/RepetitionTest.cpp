@@ -0,0 +1,71 @@
+// Bounded repetition {m}, {m,} and {m,n}: the same matches under Thompson and
+// Glushkov construction, literal braces where no repetition is written, and
+// std::length_error from the compile-size guards instead of a huge automaton.
+
+#include <stdexcept>
+#include <string>
+#include "RegexParser.h"
+#include "CompiledDFA.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static bool fullMatch(const CompiledDFA& dfa, const std::string& input) {
+    int32_t lastFinal;
+    size_t lastLength;
+    dfa.simulate(input.data(), input.size(), lastFinal, lastLength);
+    return lastFinal != -1 && lastLength == input.size();
+}
+
+// regex must accept exactly the inputs in matches among matches + rejects, both ways
+static void expect(const std::string& regex, std::initializer_list<const char*> matches, std::initializer_list<const char*> rejects) {
+    for (NFAConstruction method : { NFAConstruction::Thompson, NFAConstruction::Glushkov }) {
+        CompiledDFA dfa = CompiledDFA::compile(*RegexParser::createDFA(regex, TOKEN_IDENTIFIER, method));
+        for (const char* input : matches) {
+            if (!CHECK(fullMatch(dfa, input))) fprintf(stderr, "  %s should match \"%s\"\n", regex.c_str(), input);
+        }
+        for (const char* input : rejects) {
+            if (!CHECK(!fullMatch(dfa, input))) fprintf(stderr, "  %s should not match \"%s\"\n", regex.c_str(), input);
+        }
+    }
+}
+
+static bool throwsLengthError(const std::string& regex, NFAConstruction method) {
+    try {
+        RegexParser::createDFA(regex, TOKEN_IDENTIFIER, method);
+    } catch (const std::length_error&) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    // 1. Match correctness
+    expect("ab{0}c", { "ac" }, { "abc", "c" });
+    expect("a{3}", { "aaa" }, { "", "aa", "aaaa" });
+    expect("a{2,}", { "aa", "aaa", "aaaaaaaaaa" }, { "", "a" });
+    expect("a{2,4}", { "aa", "aaa", "aaaa" }, { "a", "aaaaa" });
+    expect("(ab|c){1,2}d", { "abd", "cd", "abcd", "ccd", "abab" "d" }, { "d", "ababcd" });
+    expect("[0-9]{2}-[0-9]{0,2}", { "12-", "12-3", "12-34" }, { "1-2", "12-345" });
+    expect("(a{2}){3}", { "aaaaaa" }, { "aaaa", "aaaaaaa" });
+    expect("x(y{1,3})*z", { "xz", "xyz", "xyyyyyyz" }, { "xy" });
+
+    // 2. Braces that do not form a repetition are literals
+    expect("a{", { "a{" }, { "a" });
+    expect("{x}", { "{x}" }, { "x" });
+    expect("a{,3}", { "a{,3}" }, { "a", "aaa" });
+    expect("a{3,1x}", { "a{3,1x}" }, { "aaa" });
+    expect("\\{2\\}", { "{2}" }, { "" });
+
+    // 3. Size guards
+    for (NFAConstruction method : { NFAConstruction::Thompson, NFAConstruction::Glushkov }) {
+        CHECK(throwsLengthError("a{1001}", method));                 // MAX_REPEAT
+        CHECK(throwsLengthError("x{1000}{1000}", method));           // MAX_NFA_STATES
+        CHECK(throwsLengthError("(abcdefghij){1000}{20}", method));  // MAX_NFA_STATES
+        CHECK(throwsLengthError("(a|b)*a(a|b){20}", method));        // MAX_DFA_STATES
+        CHECK(!throwsLengthError("x{1000}", method));
+        CHECK(!throwsLengthError("(a|b)*a(a|b){8}", method));
+    }
+
+    return Test::result("RepetitionTest");
+}
@@ -0,0 +1,114 @@
+// The combined lexer DFA keeps the old per-rule semantics: the longest match
+// wins, and among matches of the same length the rule added first. Checked
+// against the old scan that ran every rule's own DFA at each position.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "Lexer.h"
+#include "RegexParser.h"
+#include "ScanKernels.h"
+#include "Utf8.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+struct RuleSpec {
+    std::string regex;
+    TokenType type;
+};
+
+static std::vector<TokenType> types(Lexer& lexer, const std::string& input) {
+    std::vector<TokenType> out;
+    for (const auto& t : lexer.tokenizeSpans(input)) out.push_back(t.type);
+    return out;
+}
+
+// One DFA per rule, each run at every token start; longest match, first rule on ties
+static std::vector<TokenSpan> perRuleScan(const std::vector<RuleSpec>& rules, const std::string& input) {
+    std::vector<DFA> dfas;
+    for (const auto& r : rules) dfas.push_back(RegexParser::toDFA(RegexParser::toNFA(RegexParser::toPostfix(r.regex)), r.type));
+
+    std::vector<TokenSpan> out;
+    size_t cursor = 0;
+    int line = 1;
+    while (cursor < input.size()) {
+        int newlines = 0;
+        size_t spaces = ScanKernels::skipWhitespace(input.data() + cursor, input.size() - cursor, newlines);
+        if (spaces > 0) {
+            cursor += spaces;
+            line += newlines;
+            continue;
+        }
+        size_t bestLen = 0;
+        TokenType bestType = TOKEN_INVALID;
+        std::string rest = input.substr(cursor);
+        for (size_t r = 0; r < dfas.size(); r++) {
+            int lastFinal, lastIndex;
+            dfas[r].simulate(rest, lastFinal, lastIndex);
+            if (lastIndex > (int)bestLen) {
+                bestLen = (size_t)lastIndex;
+                bestType = rules[r].type;
+            }
+        }
+        if (bestLen == 0) {
+            bestType = TOKEN_UNKNOWN;
+            bestLen = std::max<size_t>(1, Utf8::sequenceLength(input.data() + cursor, input.size() - cursor));
+        }
+        out.push_back({ bestType, cursor, bestLen, line });
+        cursor += bestLen;
+    }
+    out.push_back({ TOKEN_EOF, cursor, 0, line });
+    return out;
+}
+
+int main() {
+    // 1. Ties go to the earlier rule, longer matches to whichever rule makes them
+    Lexer keywordFirst;
+    keywordFirst.addRule("if", TOKEN_KEYWORD);
+    keywordFirst.addRule("[a-z]+", TOKEN_IDENTIFIER);
+    CHECK((types(keywordFirst, "if iff i") == std::vector<TokenType>{ TOKEN_KEYWORD, TOKEN_IDENTIFIER, TOKEN_IDENTIFIER, TOKEN_EOF }));
+
+    Lexer identifierFirst;
+    identifierFirst.addRule("[a-z]+", TOKEN_IDENTIFIER);
+    identifierFirst.addRule("if", TOKEN_KEYWORD);
+    CHECK((types(identifierFirst, "if iff") == std::vector<TokenType>{ TOKEN_IDENTIFIER, TOKEN_IDENTIFIER, TOKEN_EOF }));
+
+    Lexer operators;
+    operators.addRule("=", TOKEN_OPERATOR_EQ);
+    operators.addRule("==", TOKEN_KEYWORD);
+    operators.addRule("=+", TOKEN_OPERATOR_PLUS);
+    CHECK((types(operators, "= == ===") == std::vector<TokenType>{ TOKEN_OPERATOR_EQ, TOKEN_KEYWORD, TOKEN_OPERATOR_PLUS, TOKEN_EOF }));
+
+    // 2. Random inputs against the per-rule scan, overlapping rules
+    const std::vector<RuleSpec> rules = {
+        { "while|for", TOKEN_KEYWORD },
+        { "[0-9]+", TOKEN_NUMBER },
+        { "[0-9]+\\.[0-9]+", TOKEN_NUMBER },
+        { "[a-z_][a-z0-9_]*", TOKEN_IDENTIFIER },
+        { "f[a-z]*", TOKEN_KEYWORD }, // Never wins: the identifier rule is earlier
+        { "\\+|\\+\\+", TOKEN_OPERATOR_PLUS },
+        { "=|==", TOKEN_OPERATOR_EQ },
+    };
+    Lexer lexer;
+    for (const auto& r : rules) lexer.addRule(r.regex, r.type);
+
+    std::mt19937 rng(1);
+    const std::string alphabet = "wfhileor019._+=+ \n\xC3\xA9#";
+    for (int round = 0; round < 100; round++) {
+        std::string input;
+        size_t length = rng() % 300;
+        for (size_t i = 0; i < length; i++) input += alphabet[rng() % alphabet.size()];
+
+        std::vector<TokenSpan> expected = perRuleScan(rules, input);
+        std::vector<TokenSpan> actual = lexer.tokenizeSpans(input);
+        bool same = expected.size() == actual.size();
+        for (size_t i = 0; same && i < actual.size(); i++) {
+            same = actual[i].type == expected[i].type && actual[i].offset == expected[i].offset &&
+                   actual[i].length == expected[i].length && actual[i].line == expected[i].line;
+        }
+        CHECK(same);
+    }
+
+    return Test::result("RulePriorityTest");
+}
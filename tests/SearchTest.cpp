@@ -0,0 +1,89 @@
+// RegexSearch::find and findAll (unanchored, leftmost-longest) must agree with
+// a brute-force restart loop: try an anchored longest match at every start
+// position, take the first, resume after it.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "CompiledDFA.h"
+#include "RegexParser.h"
+#include "RegexSearch.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static std::mt19937 rng(5);
+
+static std::string randomRegex(int depth) {
+    static const char* atoms[] = { "a", "b", "c", "ab", "abc", "[a-c]", "[^a]", "\\d", "\\w", ".", "1", "_", "\\n",
+                                   "[ab]{2}", "a{1,3}", "b{0}", "(ab){0,2}", "c{2,}", "(ca){3}", "x", "[xy]" };
+    switch (rng() % (depth > 3 ? 2 : 7)) {
+    case 0:
+    case 1: return atoms[rng() % (sizeof(atoms) / sizeof(atoms[0]))];
+    case 2:
+    case 3: return randomRegex(depth + 1) + randomRegex(depth + 1);
+    case 4: return "(" + randomRegex(depth + 1) + "|" + randomRegex(depth + 1) + ")";
+    case 5: return "(" + randomRegex(depth + 1) + ")*";
+    default: return "(" + randomRegex(depth + 1) + ")+";
+    }
+}
+
+// Leftmost start at or after from with an anchored match, and that match's longest length
+static bool bruteFind(const CompiledDFA& dfa, const std::string& text, size_t from, size_t& start, size_t& length) {
+    for (size_t p = from; p <= text.size(); p++) {
+        int32_t lastFinal;
+        dfa.simulate(text.data() + p, text.size() - p, lastFinal, length);
+        if (lastFinal != -1) {
+            start = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main() {
+    const char alphabet[] = "abc1_xy\n ";
+
+    for (int n = 0; n < 2000; n++) {
+        std::string regex = randomRegex(0);
+        RegexSearch search(regex);
+        CompiledDFA dfa = CompiledDFA::compile(*RegexParser::createDFA(regex, TOKEN_UNKNOWN));
+
+        for (int k = 0; k < 30; k++) {
+            std::string text;
+            int length = rng() % 60;
+            for (int i = 0; i < length; i++) text += alphabet[rng() % (sizeof(alphabet) - 1)];
+
+            // 1. find from a random position
+            size_t from = rng() % (text.size() + 1);
+            size_t expectedStart = 0, expectedLength = 0, start = 0, matched = 0;
+            bool expected = bruteFind(dfa, text, from, expectedStart, expectedLength);
+            bool found = search.find(text, from, start, matched);
+            if (!CHECK(found == expected && (!found || (start == expectedStart && matched == expectedLength)))) {
+                fprintf(stderr, "  find: regex %s, text \"%s\", from %zu\n", regex.c_str(), text.c_str(), from);
+                continue;
+            }
+
+            // 2. findAll == restart loop (empty matches advance by one byte)
+            std::vector<RegexSearch::Match> all = search.findAll(text);
+            std::vector<RegexSearch::Match> loop;
+            size_t cursor = 0;
+            while (cursor <= text.size() && bruteFind(dfa, text, cursor, expectedStart, expectedLength)) {
+                loop.push_back({ expectedStart, expectedLength });
+                cursor = expectedStart + expectedLength + (expectedLength == 0 ? 1 : 0);
+            }
+            bool same = all.size() == loop.size();
+            for (size_t i = 0; same && i < all.size(); i++) same = all[i].start == loop[i].start && all[i].length == loop[i].length;
+            if (!CHECK(same)) fprintf(stderr, "  findAll: regex %s, text \"%s\"\n", regex.c_str(), text.c_str());
+        }
+    }
+
+    // A prefiltered search over a longer text
+    std::string log;
+    for (int i = 0; i < 5000; i++) log += (i % 997 == 0) ? "ERROR: disk full timeout=30\n" : "INFO served in 12ms\n";
+    CHECK(RegexSearch("ERROR: disk").findAll(log).size() == 6);
+    CHECK(RegexSearch("timeout=[0-9]+").findAll(log).size() == 6);
+    CHECK(RegexSearch("[0-9]+ms").findAll(log).size() == 5000 - 6);
+
+    return Test::result("SearchTest");
+}
@@ -0,0 +1,76 @@
+// StreamLexer gives the same tokens as tokenizeSpans however the input is
+// chunked, and a token spanning many chunks is walked once: a 1 MB identifier
+// fed one byte at a time would take minutes if every chunk rescanned it.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "Lexer.h"
+#include "StreamLexer.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static bool sameTokens(const std::vector<TokenSpan>& a, const std::vector<TokenSpan>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].type != b[i].type || a[i].offset != b[i].offset || a[i].length != b[i].length || a[i].line != b[i].line) return false;
+    }
+    return true;
+}
+
+// Feeds text in chunks of 1..maxChunk bytes (all of size maxChunk if fixed)
+static std::vector<TokenSpan> streamed(Lexer& lexer, const std::string& text, size_t maxChunk, bool fixed, std::mt19937& rng) {
+    std::vector<TokenSpan> tokens;
+    StreamLexer stream(lexer, [&](const TokenSpan& t, std::string_view) { tokens.push_back(t); });
+    for (size_t i = 0; i < text.size();) {
+        size_t n = fixed ? maxChunk : 1 + rng() % maxChunk;
+        if (n > text.size() - i) n = text.size() - i;
+        stream.feed(text.data() + i, n);
+        i += n;
+    }
+    stream.finish();
+    return tokens;
+}
+
+int main() {
+    std::mt19937 rng(8);
+
+    Lexer lexer;
+    lexer.init();
+    lexer.addKeyword("while");
+    lexer.addKeyword("==", TOKEN_OPERATOR_EQ);
+
+    // 1. One long token per kind, in 1-byte chunks
+    const size_t LONG = 1 << 20;
+    for (const std::string& token : { std::string(LONG, 'x'), std::string(LONG, '7'), "whil" + std::string(LONG, 'e') }) {
+        std::string text = "a " + token + " == b";
+        std::vector<TokenSpan> tokens = streamed(lexer, text, 1, true, rng);
+        CHECK(sameTokens(tokens, lexer.tokenizeSpans(text)));
+        CHECK(tokens.size() == 5 && tokens[1].length == token.size());
+    }
+
+    // 2. Keyword and rule ties decided across chunk edges
+    std::string mixed;
+    for (int i = 0; i < 20000; i++) mixed += "while whiles = == ===  12 x_1\n\xC3\xA9"[rng() % 34];
+    std::vector<TokenSpan> expected = lexer.tokenizeSpans(mixed);
+    for (size_t chunk : { 1, 2, 3, 7, 64, 4096 }) {
+        CHECK(sameTokens(streamed(lexer, mixed, chunk, true, rng), expected));
+        CHECK(sameTokens(streamed(lexer, mixed, chunk, false, rng), expected));
+    }
+
+    // 3. Over-budget rules (no resumable table): still correct, and a long
+    // token fed byte by byte is rescanned only each time pending doubles
+    Lexer big;
+    big.addRule("(a|b)*a(a|b){20}", TOKEN_IDENTIFIER);
+    big.addRule("[ab]+", TOKEN_NUMBER);
+    CHECK(!big.canResumeMatch());
+    std::string run;
+    for (int i = 0; i < 100000; i++) run += "ab"[rng() % 2];
+    run += " ab ba";
+    std::vector<TokenSpan> bigTokens = streamed(big, run, 1, true, rng);
+    CHECK(sameTokens(bigTokens, big.tokenizeSpans(run)));
+    CHECK(bigTokens.size() == 4 && bigTokens[0].length == 100000);
+
+    return Test::result("StreamLexerTest");
+}
@@ -0,0 +1,139 @@
+// The hashed, single-pass subset construction in RegexParser::toDFA builds
+// the same DFA as the textbook one it replaced (std::set subsets, one move +
+// closure per input byte, linear search for known subsets): the same subsets,
+// numbered in the same order, with the same tokens and transitions.
+
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "RegexParser.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static std::set<int> closure(const NFA& nfa, std::set<int> states) {
+    std::vector<int> stack(states.begin(), states.end());
+    while (!stack.empty()) {
+        int s = stack.back(); stack.pop_back();
+        for (const auto& t : nfa.states[s].transitions) {
+            if (t.isEpsilon() && states.insert(t.targetStateId).second) stack.push_back(t.targetStateId);
+        }
+    }
+    return states;
+}
+
+// The construction as it was before the rewrite, over bytes 1..255
+static DFA referenceDFA(const NFA& nfa, const std::vector<TokenType>& ruleTypes) {
+    DFA dfa;
+    std::vector<int> ruleOf = nfa.acceptingRules();
+    auto tag = [&](State& state) {
+        int rule = -1;
+        for (int s : state.nfaStateIds) {
+            if (ruleOf[s] != -1 && (rule == -1 || ruleOf[s] < rule)) rule = ruleOf[s];
+        }
+        state.isFinal = rule != -1;
+        if (state.isFinal) dfa.stateTokenMap[state.id] = rule < (int)ruleTypes.size() ? ruleTypes[rule] : TOKEN_INVALID;
+    };
+
+    State start;
+    start.id = 0;
+    start.nfaStateIds = closure(nfa, { nfa.startStateId });
+    tag(start);
+    dfa.states.push_back(start);
+    dfa.startStateId = 0;
+
+    std::queue<int> q;
+    q.push(0);
+    while (!q.empty()) {
+        int current = q.front(); q.pop();
+        std::set<int> subset = dfa.states[current].nfaStateIds;
+        for (int b = 1; b < 256; b++) {
+            std::set<int> moved;
+            for (int s : subset) {
+                for (const auto& t : nfa.states[s].transitions) {
+                    if (t.matches((char)b)) moved.insert(t.targetStateId);
+                }
+            }
+            if (moved.empty()) continue;
+            std::set<int> next = closure(nfa, moved);
+
+            int target = -1;
+            for (const auto& s : dfa.states) {
+                if (s.nfaStateIds == next) { target = s.id; break; }
+            }
+            if (target == -1) {
+                State fresh;
+                fresh.id = target = (int)dfa.states.size();
+                fresh.nfaStateIds = next;
+                tag(fresh);
+                dfa.states.push_back(fresh);
+                q.push(target);
+            }
+            dfa.states[current].transitions.push_back({ (char)b, target });
+        }
+    }
+    return dfa;
+}
+
+static int successor(const DFA& dfa, int state, unsigned char b) {
+    for (const auto& t : dfa.states[state].transitions) {
+        if (t.matches((char)b)) return t.targetStateId;
+    }
+    return -1;
+}
+
+static bool sameDFA(const DFA& a, const DFA& b) {
+    if (a.states.size() != b.states.size() || a.startStateId != b.startStateId) return false;
+    for (size_t i = 0; i < a.states.size(); i++) {
+        const State& x = a.states[i];
+        const State& y = b.states[i];
+        if (x.nfaStateIds != y.nfaStateIds || x.isFinal != y.isFinal) return false;
+        if (x.isFinal && a.stateTokenMap.at(x.id) != b.stateTokenMap.at(y.id)) return false;
+        for (int c = 1; c < 256; c++) {
+            if (successor(a, x.id, (unsigned char)c) != successor(b, y.id, (unsigned char)c)) return false;
+        }
+    }
+    return true;
+}
+
+static std::string randomRegex(std::mt19937& rng, int depth) {
+    int pick = depth <= 0 ? (int)(rng() % 3) : (int)(rng() % 8);
+    switch (pick) {
+        case 0: return std::string(1, "abc"[rng() % 3]);
+        case 1: return "[a-b]";
+        case 2: return "[^a\\n]";
+        case 3: return randomRegex(rng, depth - 1) + randomRegex(rng, depth - 1);
+        case 4: return "(" + randomRegex(rng, depth - 1) + "|" + randomRegex(rng, depth - 1) + ")";
+        case 5: return "(" + randomRegex(rng, depth - 1) + ")*";
+        case 6: return "(" + randomRegex(rng, depth - 1) + ")+";
+        default: return "(" + randomRegex(rng, depth - 1) + "){1,2}";
+    }
+}
+
+int main() {
+    // 1. Single rules, fixed and random
+    std::vector<std::string> regexes = { "a", "(a|b)*abb", "[0-9]+(\\.[0-9]+)?", "(a*b*)*c", "x{2,3}|xy", "[^\"]*\"" };
+    std::mt19937 rng(12);
+    for (int i = 0; i < 150; i++) regexes.push_back(randomRegex(rng, 4));
+
+    for (const auto& regex : regexes) {
+        for (NFAConstruction method : { NFAConstruction::Thompson, NFAConstruction::Glushkov }) {
+            NFA nfa = RegexParser::toNFA(RegexParser::toPostfix(regex), method);
+            CHECK(sameDFA(RegexParser::toDFA(nfa, TOKEN_IDENTIFIER), referenceDFA(nfa, { TOKEN_IDENTIFIER })));
+        }
+    }
+
+    // 2. Combined rules: the earliest rule's token on shared subsets
+    NFA combined = RegexParser::combineNFAs({
+        RegexParser::toNFA(RegexParser::toPostfix("if|for")),
+        RegexParser::toNFA(RegexParser::toPostfix("[a-z]+")),
+        RegexParser::toNFA(RegexParser::toPostfix("[0-9]+|0x[0-9a-f]+")),
+    });
+    std::vector<TokenType> ruleTypes = { TOKEN_KEYWORD, TOKEN_IDENTIFIER, TOKEN_NUMBER };
+    CHECK(sameDFA(RegexParser::toDFA(combined, ruleTypes), referenceDFA(combined, ruleTypes)));
+
+    return Test::result("SubsetConstructionTest");
+}
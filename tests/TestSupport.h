@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdio>
+
+// Minimal checking for the test executables: a failed CHECK is printed and
+// counted, and main returns Test::result() so ctest sees the failure.
+namespace Test {
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline bool check(bool ok, const char* expression, const char* file, int line) {
+        if (!ok) {
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expression);
+            failures()++;
+        }
+        return ok;
+    }
+
+    inline int result(const char* name) {
+        printf("%s: %s (%d failure%s)\n", name, failures() ? "FAILED" : "passed", failures(), failures() == 1 ? "" : "s");
+        return failures() ? 1 : 0;
+    }
+
+}
+
+#define CHECK(expression) Test::check((expression), #expression, __FILE__, __LINE__)
@@ -0,0 +1,100 @@
+// tokenizeSpans offsets and lines: spans are in order and do not overlap,
+// only whitespace lies between them, each line is 1 + the newlines before the
+// token, and TOKEN_EOF sits at the end. tokenize() copies the same spans.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "Lexer.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static bool isSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static void checkSpans(Lexer& lexer, const std::string& input) {
+    std::vector<TokenSpan> spans = lexer.tokenizeSpans(input);
+    CHECK(!spans.empty());
+    if (spans.empty()) return;
+
+    size_t cursor = 0;
+    int line = 1;
+    bool ordered = true, gapsAreSpace = true, linesRight = true, nonEmpty = true;
+    for (size_t i = 0; i + 1 < spans.size(); i++) {
+        const TokenSpan& t = spans[i];
+        if (t.offset < cursor || t.offset + t.length > input.size()) {
+            ordered = false;
+            break;
+        }
+        for (size_t k = cursor; k < t.offset; k++) {
+            if (!isSpace(input[k])) gapsAreSpace = false;
+            if (input[k] == '\n') line++;
+        }
+        if (t.line != line) linesRight = false;
+        if (t.length == 0) nonEmpty = false;
+        for (size_t k = t.offset; k < t.offset + t.length; k++) {
+            if (input[k] == '\n') line++; // Tokens may contain newlines (none of these rules do)
+        }
+        cursor = t.offset + t.length;
+    }
+    for (size_t k = cursor; ordered && k < input.size(); k++) {
+        if (!isSpace(input[k])) gapsAreSpace = false;
+        if (input[k] == '\n') line++;
+    }
+    CHECK(ordered);
+    CHECK(gapsAreSpace);
+    CHECK(linesRight);
+    CHECK(nonEmpty);
+
+    const TokenSpan& eof = spans.back();
+    CHECK(eof.type == TOKEN_EOF && eof.offset == input.size() && eof.length == 0 && eof.line == line);
+
+    // tokenize() is the same stream with owned copies
+    std::vector<Token> tokens = lexer.tokenize(input);
+    bool same = tokens.size() == spans.size();
+    for (size_t i = 0; same && i < spans.size(); i++) {
+        same = tokens[i].type == spans[i].type && tokens[i].position == (int)spans[i].offset && tokens[i].line == spans[i].line &&
+               tokens[i].value == input.substr(spans[i].offset, spans[i].length);
+    }
+    CHECK(same);
+}
+
+int main() {
+    Lexer lexer;
+    lexer.init();
+
+    // 1. Known input
+    std::string text = "x = 12\n  y1=(x+3)\n\n{ z }\t\xC3\xA9 #";
+    std::vector<TokenSpan> spans = lexer.tokenizeSpans(text);
+    CHECK(spans.size() == 16);
+    if (spans.size() == 16) {
+        CHECK(spans[0].type == TOKEN_IDENTIFIER && spans[0].offset == 0 && spans[0].length == 1 && spans[0].line == 1);
+        CHECK(spans[2].type == TOKEN_NUMBER && spans[2].offset == 4 && spans[2].length == 2 && spans[2].line == 1);
+        CHECK(spans[3].type == TOKEN_IDENTIFIER && spans[3].offset == 9 && spans[3].length == 2 && spans[3].line == 2);
+        CHECK(spans[10].type == TOKEN_LBRACE && spans[10].offset == 19 && spans[10].line == 4);
+        CHECK(spans[13].type == TOKEN_UNKNOWN && spans[13].offset == 25 && spans[13].length == 2); // One UTF-8 character
+        CHECK(spans[14].type == TOKEN_UNKNOWN && spans[14].offset == 28 && spans[14].length == 1);
+        CHECK(spans[15].type == TOKEN_EOF && spans[15].offset == text.size() && spans[15].line == 4);
+    }
+    checkSpans(lexer, text);
+
+    // 2. Edge inputs
+    for (const std::string input : { "", " ", "\n\n", "x", "\n x", "x\n", "\xFF", "\xC3", "abc\r\ndef" }) {
+        checkSpans(lexer, input);
+    }
+    CHECK(lexer.tokenizeSpans("\n\n\n").back().line == 4);
+
+    // 3. Random inputs, including bytes no rule matches
+    std::mt19937 rng(4);
+    const std::string alphabet = "ab1_+-*/=(){} \t\n\r\v\f#\xC3\xA9\xE2\x82\xAC\xFF";
+    for (int round = 0; round < 200; round++) {
+        std::string input;
+        size_t length = rng() % 400;
+        for (size_t i = 0; i < length; i++) input += alphabet[rng() % alphabet.size()];
+        checkSpans(lexer, input);
+    }
+
+    return Test::result("TokenSpanTest");
+}
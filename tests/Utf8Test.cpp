@@ -0,0 +1,133 @@
+// UTF-8 range expansion: the byte sequences for [first, last] cover exactly
+// the encodings of its code points, surrogates excluded, across the
+// 0x7F / 0x7FF / 0xFFFF / 0x10FFFF length boundaries. Regexes built from
+// them accept those encodings and reject surrogates and overlong forms.
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "RegexParser.h"
+#include "Utf8.h"
+#include "TestSupport.h"
+
+using namespace Automata;
+
+static bool isSurrogate(uint32_t cp) {
+    return cp >= Utf8::SURROGATE_FIRST && cp <= Utf8::SURROGATE_LAST;
+}
+
+// Every byte string in every sequence is the well-formed encoding of a code
+// point in [first, last], and each such code point is produced exactly once
+static bool exactCover(uint32_t first, uint32_t last) {
+    std::vector<Utf8::Sequence> sequences;
+    Utf8::rangeSequences(first, last, sequences);
+
+    std::vector<char> seen(last - first + 1, 0);
+    for (const auto& seq : sequences) {
+        std::string bytes(seq.size(), '\0');
+        // Odometer over the product of the byte ranges
+        std::vector<int> value(seq.size());
+        for (size_t i = 0; i < seq.size(); i++) value[i] = seq[i].lo;
+        while (true) {
+            for (size_t i = 0; i < seq.size(); i++) bytes[i] = (char)value[i];
+            if (Utf8::sequenceLength(bytes.data(), bytes.size()) != bytes.size()) return false;
+            uint32_t cp = Utf8::decode(bytes.data(), bytes.size());
+            if (cp < first || cp > last || seen[cp - first]) return false;
+            seen[cp - first] = 1;
+
+            size_t i = seq.size();
+            while (i > 0 && value[i - 1] == seq[i - 1].hi) {
+                value[i - 1] = seq[i - 1].lo;
+                i--;
+            }
+            if (i == 0) break;
+            value[i - 1]++;
+        }
+    }
+    for (uint32_t cp = first; cp <= last; cp++) {
+        if (!seen[cp - first] && !isSurrogate(cp)) return false;
+    }
+    return true;
+}
+
+static bool wholeMatch(DFA& dfa, const std::string& input) {
+    int lastFinal, lastIndex;
+    dfa.simulate(input, lastFinal, lastIndex);
+    return lastIndex == (int)input.size();
+}
+
+static DFA build(const std::string& regex) {
+    return RegexParser::toDFA(RegexParser::toNFA(RegexParser::toPostfix(regex)), TOKEN_IDENTIFIER);
+}
+
+int main() {
+    // 1. Range expansion at and across every length boundary
+    const uint32_t ranges[][2] = {
+        { 0x00, 0x7F }, { 0x7F, 0x80 }, { 0x7E, 0x7FF }, { 0x7FF, 0x800 }, { 0x800, 0xFFFF }, { 0xFFFF, 0x10000 },
+        { 0x10000, 0x10FFFF }, { 0x10FFFE, 0x10FFFF }, { 0x00, 0x10FFFF }, { 0xD7FF, 0xE000 }, { 0xD800, 0xDFFF },
+        { 0x3F, 0x41 }, { 0x7C0, 0x7C0 }, { 0xFFC0, 0x10040 },
+    };
+    for (const auto& r : ranges) CHECK(exactCover(r[0], r[1]));
+
+    std::mt19937 rng(23);
+    for (int i = 0; i < 200; i++) {
+        uint32_t a = rng() % 0x110000, b = a + rng() % (i < 100 ? 300 : 0x20000);
+        if (b > Utf8::MAX_CODE_POINT) b = Utf8::MAX_CODE_POINT;
+        CHECK(exactCover(a, b));
+    }
+
+    // Surrogates have no encoding; past U+10FFFF is clipped
+    std::vector<Utf8::Sequence> none;
+    Utf8::rangeSequences(0xD800, 0xDFFF, none);
+    CHECK(none.empty());
+    Utf8::rangeSequences(0x110000, 0x120000, none);
+    CHECK(none.empty());
+
+    // 2. sequenceLength at the boundaries, rejecting overlongs and surrogates
+    CHECK(Utf8::sequenceLength("\x7F", 1) == 1);
+    CHECK(Utf8::sequenceLength("\xC2\x80", 2) == 2);
+    CHECK(Utf8::sequenceLength("\xDF\xBF", 2) == 2);
+    CHECK(Utf8::sequenceLength("\xE0\xA0\x80", 3) == 3);
+    CHECK(Utf8::sequenceLength("\xEF\xBF\xBF", 3) == 3);
+    CHECK(Utf8::sequenceLength("\xF0\x90\x80\x80", 4) == 4);
+    CHECK(Utf8::sequenceLength("\xF4\x8F\xBF\xBF", 4) == 4);
+    CHECK(Utf8::sequenceLength("\xC1\xBF", 2) == 0);         // Overlong U+7F
+    CHECK(Utf8::sequenceLength("\xE0\x9F\xBF", 3) == 0);     // Overlong U+7FF
+    CHECK(Utf8::sequenceLength("\xF0\x8F\xBF\xBF", 4) == 0); // Overlong U+FFFF
+    CHECK(Utf8::sequenceLength("\xED\xA0\x80", 3) == 0);     // U+D800
+    CHECK(Utf8::sequenceLength("\xED\xBF\xBF", 3) == 0);     // U+DFFF
+    CHECK(Utf8::sequenceLength("\xF4\x90\x80\x80", 4) == 0); // U+110000
+    CHECK(Utf8::sequenceLength("\x80", 1) == 0);
+    bool truncated = false;
+    CHECK(Utf8::sequenceLength("\xE2\x82", 2, &truncated) == 0 && truncated);
+
+    // 3. Regexes over code points
+    DFA boundary = build("[\\u{7F}-\\u{80}]");
+    CHECK(wholeMatch(boundary, "\x7F") && wholeMatch(boundary, "\xC2\x80"));
+    CHECK(!wholeMatch(boundary, "\x7E") && !wholeMatch(boundary, "\xC2\x81") && !wholeMatch(boundary, "\xC1\xBF"));
+
+    DFA top = build("\\u{10FFFF}");
+    CHECK(wholeMatch(top, "\xF4\x8F\xBF\xBF") && !wholeMatch(top, "\xF4\x90\x80\x80"));
+
+    DFA aroundSurrogates = build("[\\u{D7FF}-\\u{E000}]");
+    CHECK(wholeMatch(aroundSurrogates, "\xED\x9F\xBF") && wholeMatch(aroundSurrogates, "\xEE\x80\x80"));
+    CHECK(!wholeMatch(aroundSurrogates, "\xED\xA0\x80") && !wholeMatch(aroundSurrogates, "\xED\xBF\xBF"));
+
+    DFA surrogate = build("\\u{D800}");
+    CHECK(!wholeMatch(surrogate, "\xED\xA0\x80"));
+
+    DFA notA = build("[^\\u0061]"); // A \u escape makes the class a set of code points
+    CHECK(wholeMatch(notA, "\xC3\xA9") && wholeMatch(notA, "\xF0\x9F\x98\x80") && !wholeMatch(notA, "a"));
+    CHECK(!wholeMatch(notA, "\xED\xA0\x80") && !wholeMatch(notA, "\xC0\x80"));
+
+    bool threw = false;
+    try {
+        build("\\u{110000}");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    return Test::result("Utf8Test");
+}
@@ -0,0 +1,87 @@
+// Thread-scaling benchmark for Lexer::tokenizeParallel: tokenizes one large
+// synthetic source with 1, 2, 4, ... hardware_concurrency threads, reports the
+// throughput of each run and checks every token stream against the sequential
+// tokenizeSpans output.
+//
+// Usage: ParallelBench [megabytes]   (default 32)
+//   exits 1 if any thread count produces a different token stream
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Lexer.h"
+
+using namespace Automata;
+
+// Assignments, arithmetic and blocks with a few comment-like and non-ASCII lines
+static std::string syntheticSource(size_t bytes) {
+    const char* words[] = { "value", "count", "x", "total_sum", "i", "buffer_index", "tmp2", "result" };
+    const char* ops[] = { " + ", " - ", " * ", " / " };
+    std::mt19937 rng(42);
+    std::string out;
+    out.reserve(bytes + 128);
+    while (out.size() < bytes) {
+        switch (rng() % 6) {
+        case 0: out += "{\n"; break;
+        case 1: out += "}\n"; break;
+        case 2: out += "# caf\xC3\xA9 \xE2\x82\xAC note\n"; break;
+        default:
+            out += words[rng() % 8];
+            out += " = (";
+            out += words[rng() % 8];
+            out += ops[rng() % 4];
+            out += std::to_string(rng() % 100000);
+            out += ")\n";
+        }
+    }
+    return out;
+}
+
+static bool sameTokens(const std::vector<TokenSpan>& a, const std::vector<TokenSpan>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].type != b[i].type || a[i].offset != b[i].offset || a[i].length != b[i].length || a[i].line != b[i].line) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t megabytes = (argc > 1) ? (size_t)std::strtoul(argv[1], nullptr, 10) : 32;
+    if (megabytes == 0) megabytes = 1;
+    std::string input = syntheticSource(megabytes * 1024 * 1024);
+
+    Lexer lexer;
+    lexer.init();
+
+    auto seconds = [](auto start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<TokenSpan> expected = lexer.tokenizeSpans(input);
+    double sequential = seconds(start);
+    double mb = input.size() / (1024.0 * 1024.0);
+    printf("%.1f MB, %zu tokens\n", mb, expected.size());
+    printf("sequential   %8.1f MB/s\n", mb / sequential);
+
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+
+    bool ok = true;
+    for (unsigned threads : counts) {
+        start = std::chrono::steady_clock::now();
+        std::vector<TokenSpan> tokens = lexer.tokenizeParallel(input, threads);
+        double elapsed = seconds(start);
+        bool same = sameTokens(tokens, expected);
+        ok = ok && same;
+        printf("%2u thread%s  %8.1f MB/s  x%.2f%s\n", threads, threads == 1 ? " " : "s", mb / elapsed, sequential / elapsed,
+               same ? "" : "  MISMATCH");
+    }
+    return ok ? 0 : 1;
+}
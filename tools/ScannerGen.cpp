@@ -0,0 +1,184 @@
+// Scanner generator: compiles the rule set Lexer::init registers (through
+// RegexParser, checking the BuiltinLexer.h copy against it) and writes a
+// standalone C++ scanner (one goto label per DFA state, a switch per state)
+// that produces the same token stream as Lexer::tokenizeSpans without
+// building any automaton at runtime.
+//
+// Usage: ScannerGen <output directory>
+//   writes GeneratedScanner.h and GeneratedScanner.cpp, plus DefaultLexer.dfa
+//   (the same tables as a LexerImage, for Lexer::loadTables)
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Lexer.h"
+
+using namespace Automata;
+
+static std::string byteLiteral(int b) {
+    char buf[16];
+    if (b > ' ' && b < 0x7F && b != '\'' && b != '\\') snprintf(buf, sizeof(buf), "'%c'", b);
+    else snprintf(buf, sizeof(buf), "0x%02X", b);
+    return buf;
+}
+
+static std::string generateHeader() {
+    std::ostringstream out;
+    out << "// Generated by ScannerGen from the Lexer::init rule set. Do not edit.\n"
+        << "#pragma once\n"
+        << "#include <cstddef>\n"
+        << "#include <string_view>\n"
+        << "#include <vector>\n"
+        << "#include \"FA.h\"\n\n"
+        << "namespace Automata {\n"
+        << "    namespace GeneratedScanner {\n\n"
+        << "        // Longest rule match at data (0 if none), like Lexer::matchToken\n"
+        << "        size_t matchToken(const char* data, size_t length, TokenType& type);\n\n"
+        << "        // Same token stream as Lexer::tokenizeSpans with the default rules\n"
+        << "        std::vector<TokenSpan> tokenize(std::string_view input);\n"
+        << "    }\n"
+        << "}\n";
+    return out.str();
+}
+
+static std::string generateSource(const CompiledDFA& dfa) {
+    std::ostringstream out;
+    out << "// Generated by ScannerGen from the Lexer::init rule set. Do not edit.\n"
+        << "#include \"GeneratedScanner.h\"\n"
+        << "#include \"Utf8.h\"\n"
+        << "#include <cctype>\n\n"
+        << "namespace Automata {\n"
+        << "    namespace GeneratedScanner {\n\n"
+        << "        size_t matchToken(const char* data, size_t length, TokenType& type) {\n"
+        << "            size_t i = 0;\n"
+        << "            size_t lastLength = 0;\n"
+        << "            int lastType = -1;\n";
+
+    if (dfa.empty()) {
+        out << "            goto done;\n";
+    } else {
+        out << "            goto S" << dfa.getStartState() << ";\n";
+    }
+
+    for (int32_t s = 1; s < dfa.getStateCount(); s++) {
+        out << "\n        S" << s << ":\n";
+        if (dfa.isAccepting(s)) {
+            out << "            lastLength = i;\n"
+                << "            lastType = " << (int)dfa.tokenFor(s) << ";\n";
+        }
+
+        // Group bytes by target state; dead transitions fall through to default
+        std::map<int32_t, std::vector<int>> byTarget;
+        for (int b = 0; b < 256; b++) {
+            int32_t target = dfa.next(s, (unsigned char)b);
+            if (target != CompiledDFA::DEAD_STATE) byTarget[target].push_back(b);
+        }
+
+        if (byTarget.empty()) {
+            out << "            goto done;\n";
+            continue;
+        }
+
+        out << "            if (i >= length) goto done;\n"
+            << "            switch ((unsigned char)data[i++]) {\n";
+        for (const auto& [target, bytes] : byTarget) {
+            out << "            ";
+            for (size_t k = 0; k < bytes.size(); k++) {
+                out << "case " << byteLiteral(bytes[k]) << ":";
+                out << (((k + 1) % 8 == 0 && k + 1 < bytes.size()) ? "\n            " : " ");
+            }
+            out << "goto S" << target << ";\n";
+        }
+        out << "            default: goto done;\n"
+            << "            }\n";
+    }
+
+    out << "\n        done:\n"
+        << "            if (lastType < 0 || lastLength == 0) return 0;\n"
+        << "            type = (TokenType)lastType;\n"
+        << "            return lastLength;\n"
+        << "        }\n\n";
+
+    // Driver loop mirrors Lexer::scanStep / tokenizeSpans
+    out << "        std::vector<TokenSpan> tokenize(std::string_view input) {\n"
+        << "            std::vector<TokenSpan> output;\n"
+        << "            size_t cursor = 0;\n"
+        << "            int line = 1;\n\n"
+        << "            while (cursor < input.length()) {\n"
+        << "                unsigned char c = (unsigned char)input[cursor];\n"
+        << "                if (c == ' ' || (c >= '\\t' && c <= '\\r')) { // \"C\" locale isspace, as ScanKernels\n"
+        << "                    if (input[cursor] == '\\n') line++;\n"
+        << "                    cursor++;\n"
+        << "                    continue;\n"
+        << "                }\n\n"
+        << "                TokenType type = TOKEN_INVALID;\n"
+        << "                size_t len = matchToken(input.data() + cursor, input.length() - cursor, type);\n"
+        << "                if (len > 0) {\n"
+        << "                    output.push_back({ type, cursor, len, line });\n"
+        << "                    cursor += len;\n"
+        << "                } else {\n"
+        << "                    // One UNKNOWN token per UTF-8 character, not per byte\n"
+        << "                    size_t unknownLen = Utf8::sequenceLength(input.data() + cursor, input.length() - cursor);\n"
+        << "                    if (unknownLen == 0) unknownLen = 1;\n"
+        << "                    output.push_back({ TOKEN_UNKNOWN, cursor, unknownLen, line });\n"
+        << "                    cursor += unknownLen;\n"
+        << "                }\n"
+        << "            }\n\n"
+        << "            output.push_back({ TOKEN_EOF, cursor, 0, line });\n"
+        << "            return output;\n"
+        << "        }\n"
+        << "    }\n"
+        << "}\n";
+    return out.str();
+}
+
+static bool writeFile(const std::string& path, const std::string& content) {
+    // Leave an identical file untouched so dependent objects are not rebuilt
+    std::ifstream existing(path, std::ios::binary);
+    if (existing) {
+        std::stringstream ss;
+        ss << existing.rdbuf();
+        if (ss.str() == content) return true;
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out << content;
+    return (bool)out;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <output directory>\n", argv[0]);
+        return 1;
+    }
+    std::string dir = argv[1];
+
+    Lexer lexer;
+    lexer.init();
+
+    // init() installs the compile-time tables (BuiltinLexer.h). Build the rules
+    // through RegexParser instead, so the output follows the regexes in init()...
+    const CompiledDFA builtin = lexer.getScanner();
+    lexer.getCombinedDFA();
+    const CompiledDFA& dfa = lexer.getScanner();
+
+    // ...and stop the build if Builtin::defaultRules() no longer matches them
+    if (!CompiledDFA::equivalent(dfa, builtin)) {
+        fprintf(stderr, "ScannerGen: Builtin::defaultRules() differs from the regexes in Lexer::init\n");
+        return 1;
+    }
+
+    if (!writeFile(dir + "/GeneratedScanner.h", generateHeader()) ||
+        !writeFile(dir + "/GeneratedScanner.cpp", generateSource(dfa)) ||
+        !lexer.saveTables(dir + "/DefaultLexer.dfa")) {
+        fprintf(stderr, "ScannerGen: cannot write to %s\n", dir.c_str());
+        return 1;
+    }
+
+    printf("ScannerGen: %d states, %d byte classes\n", dfa.getStateCount(), dfa.getClassCount());
+    return 0;
+}